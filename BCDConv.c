@@ -0,0 +1,144 @@
+/**
+ * @file	BCDConv.c
+ * Portable C versions of the BCDConv.s routines.
+ * These mirror the assembly one bit at a time (shift a bit in, then double the
+ * BCD result with decimal carry, like DADD does), so they give identical
+ * results. Link either BCDConv.s or BCDConv.c, not both. The C versions are
+ * for host builds, where results and timings can be checked against the
+ * assembly.
+ *
+ * @author	Scott Teal
+ * @date	May 6, 2014
+ * @copyright
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Cognoscan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include "BCDConv.h"
+
+/**
+ * Equivalent of "dadd.w Rn, Rn": double a 4-digit BCD value and add the carry.
+ * @param	bcd		The 4 digit BCD value to double.
+ * @param	carry	Carry in, replaced with the carry out.
+ * @return	The doubled BCD value.
+ */
+static uint16_t bcd_double(uint16_t bcd, uint8_t *carry)
+{
+	uint16_t result = 0;
+	uint8_t c = *carry;
+	uint8_t shift;
+	uint8_t digit;
+
+	for (shift = 0; shift < 16; shift += 4)
+	{
+		digit = ((bcd >> shift) & 0x0F) * 2 + c;
+		c = (digit > 9);
+		if (c)
+		{
+			digit -= 10;
+		}
+		result |= (uint16_t)digit << shift;
+	}
+	*carry = c;
+	return result;
+}
+
+uint16_t bin2bcd8(uint8_t bin)
+{
+	uint16_t result = 0;
+	uint8_t carry;
+	uint8_t i;
+
+	for (i = 8; i > 0; i--)
+	{
+		carry = (bin >> 7) & 1;
+		bin <<= 1;
+		result = bcd_double(result, &carry);
+	}
+	return result;
+}
+
+uint16_t bin2bcd16(uint16_t bin)
+{
+	return (uint16_t)bin2bcd16l(bin);
+}
+
+uint32_t bin2bcd16l(uint16_t bin)
+{
+	uint16_t low = 0;
+	uint16_t high = 0;
+	uint8_t carry;
+	uint8_t i;
+
+	for (i = 16; i > 0; i--)
+	{
+		carry = (bin >> 15) & 1;
+		bin <<= 1;
+		low = bcd_double(low, &carry);
+		high = bcd_double(high, &carry);
+	}
+	return ((uint32_t)high << 16) | low;
+}
+
+uint64_t bin2bcd32(uint32_t bin)
+{
+	uint16_t digits[3] = {0, 0, 0};
+	uint8_t carry;
+	uint8_t i;
+	uint8_t j;
+
+	for (i = 32; i > 0; i--)
+	{
+		carry = (bin >> 31) & 1;
+		bin <<= 1;
+		for (j = 0; j < 3; j++)
+		{
+			digits[j] = bcd_double(digits[j], &carry);
+		}
+	}
+	return ((uint64_t)digits[2] << 32)
+		| ((uint64_t)digits[1] << 16)
+		| digits[0];
+}
+
+uint16_t bin2bcd8_unrolled(uint8_t bin)
+{
+	return bin2bcd8(bin);
+}
+
+uint16_t bin2bcd16_unrolled(uint16_t bin)
+{
+	return bin2bcd16(bin);
+}
+
+uint8_t bcd2bin8(uint8_t bcd)
+{
+	uint8_t tens = bcd & 0xF0;				// tens * 16
+	return (bcd & 0x0F) + (tens >> 1) + (tens >> 3);
+}
+
+uint16_t bcd2bin16(uint16_t bcd)
+{
+	uint16_t upper = bcd2bin8(bcd >> 8);
+	return bcd2bin8(bcd & 0xFF) + (upper << 6) + (upper << 5) + (upper << 2);
+}
@@ -32,8 +32,11 @@
 #ifndef BCDCONV_H_
 #define BCDCONV_H_
 
+#include <stdint.h>
+
 /**
  * Converts an 8-bit binary value to 16-bit BCD.
+ * Takes 46 cycles, plus 5 for the call.
  * @param	bin		The 8-bit binary value to convert.
  * @return	The converted 4 character (4 nibble) BCD result.
  */
@@ -42,9 +45,62 @@ extern uint16_t bin2bcd8(uint8_t bin);
 /**
  * Converts a 16-bit binary value to 16-bit BCD.
  * It does not handle values over 9999 properly, due to not having a 5th digit.
+ * Takes 87 cycles, plus 5 for the call.
  * @param	bin		The 16-bit binary value to convert.
  * @return	The converted 4 character (4 nibble) BCD result
  */
 extern uint16_t bin2bcd16(uint16_t bin);
 
+/**
+ * Converts a 16-bit binary value to 20-bit BCD.
+ * Handles the full 16-bit range (up to 65535).
+ * Takes 83 cycles, plus 5 for the call.
+ * @param	bin		The 16-bit binary value to convert.
+ * @return	The converted 5 character BCD result. The lower 16 bits hold the
+ * 			first 4 digits, and bits 16-19 hold the 5th.
+ */
+extern uint32_t bin2bcd16l(uint16_t bin);
+
+/**
+ * Converts a 32-bit binary value to 40-bit BCD.
+ * Handles the full 32-bit range (up to 4294967295).
+ * Takes 221 cycles, plus 5 for the call.
+ * @param	bin		The 32-bit binary value to convert.
+ * @return	The converted 10 character BCD result, in the lower 40 bits.
+ */
+extern uint64_t bin2bcd32(uint32_t bin);
+
+/**
+ * Same as bin2bcd8, with the conversion loop unrolled.
+ * Takes 21 cycles, plus 5 for the call.
+ * @param	bin		The 8-bit binary value to convert.
+ * @return	The converted 4 character (4 nibble) BCD result.
+ */
+extern uint16_t bin2bcd8_unrolled(uint8_t bin);
+
+/**
+ * Same as bin2bcd16, with the conversion loop unrolled.
+ * It does not handle values over 9999 properly, due to not having a 5th digit.
+ * Takes 37 cycles, plus 5 for the call.
+ * @param	bin		The 16-bit binary value to convert.
+ * @return	The converted 4 character (4 nibble) BCD result
+ */
+extern uint16_t bin2bcd16_unrolled(uint16_t bin);
+
+/**
+ * Converts a 2-digit packed BCD byte to binary.
+ * Takes 13 cycles, plus 5 for the call.
+ * @param	bcd		The BCD value to convert (0x00 to 0x99).
+ * @return	The binary result, 0 to 99.
+ */
+extern uint8_t bcd2bin8(uint8_t bcd);
+
+/**
+ * Converts a 4-digit packed BCD word to binary.
+ * Takes 35 cycles, plus 5 for the call.
+ * @param	bcd		The BCD value to convert (0x0000 to 0x9999).
+ * @return	The binary result, 0 to 9999.
+ */
+extern uint16_t bcd2bin16(uint16_t bcd);
+
 #endif /* BCDCONV_H_ */
@@ -4,6 +4,12 @@
 ; Date: 2012-09-26
 ;
 ; Functions for efficient conversion from binary to BCD
+;
+; Cycle counts are for the G2xx CPU (not CPUX): 1 for a register to register
+; instruction or a constant generator source (#0, #1, #2, #4, #8, #-1), 2 for
+; any other immediate, 2 for a jump taken or not, 3 for ret, and 5 for the
+; call #addr that gets there.
+; `make -C host cycles` measures them on mspdebug's simulator.
 ; Copyright:
 ; The MIT License (MIT)
 ; 
@@ -37,6 +43,7 @@
 ; bin2bcd8
 ; Takes in a binary 8-bit value and converts it to BCD.
 ; The result can be up to 3 nibbles long.
+; Cycles: 46, plus 5 for the call.
 ; *****************************************************************************
 
   .global bin2bcd8
@@ -57,6 +64,7 @@ bin2bcd8L:
 ; Takes in a binary 16-bit value and converts it to BCD.
 ; The result can be up to 4 nibbles long, meaning that anything over 9999 will
 ; not convert properly.
+; Cycles: 87, plus 5 for the call.
 ; *****************************************************************************
 
   .global bin2bcd16
@@ -72,4 +80,209 @@ bin2bcd16L:
   mov     R13,R12      ; Put result in R12
   ret
 
+; *****************************************************************************
+; bin2bcd16l
+; Takes in a binary 16-bit value and converts it to BCD, including the 5th
+; digit. Low 4 digits are returned in R12 and the 5th digit in R13, so the
+; result is a 32-bit value to C.
+; The first 13 bits can't make a number over 9999, so the 5th digit register
+; is only touched for the last 3 bits.
+; Cycles: 83, plus 5 for the call.
+; *****************************************************************************
+
+  .global bin2bcd16l
+
+bin2bcd16l:
+  mov     #0,R13      ; BCD result, low 4 digits
+  mov     #0,R14      ; BCD result, 5th digit
+  mov     #13,R15     ; loop counter
+bin2bcd16lL:
+  rla.w   R12         ; Loads highest bit into C
+  dadd.w  R13, R13    ; BCD routine
+  dec     R15         ; decrement loop counter
+  jnz     bin2bcd16lL ; LOOP
+  rla.w   R12         ; Bit 2
+  dadd.w  R13, R13
+  dadd.w  R14, R14    ; Carry into 5th digit
+  rla.w   R12         ; Bit 1
+  dadd.w  R13, R13
+  dadd.w  R14, R14
+  rla.w   R12         ; Bit 0
+  dadd.w  R13, R13
+  dadd.w  R14, R14
+  mov     R13,R12     ; Low 4 digits in R12
+  mov     R14,R13     ; 5th digit in R13
+  ret
+
+; *****************************************************************************
+; bin2bcd32
+; Takes in a binary 32-bit value (R12 low word, R13 high word) and converts it
+; to BCD. The result can be up to 10 digits long, and is returned as a 64-bit
+; value: digits 0-3 in R12, 4-7 in R13, 8-9 in R14, and R15 cleared.
+; The high word is shifted in first. 16 bits fit in 5 digits, so the DADD chain
+; only needs the third register while the low word is shifted in.
+; Cycles: 221, plus 5 for the call.
+; *****************************************************************************
+
+  .global bin2bcd32
+
+bin2bcd32:
+  mov     #0,R14      ; BCD result, digits 0-3
+  mov     #0,R15      ; BCD result, digits 4-7
+  mov     #16,R11     ; loop counter
+bin2bcd32H:
+  rla.w   R13         ; Loads highest bit of high word into C
+  dadd.w  R14, R14    ; BCD routine
+  dadd.w  R15, R15    ; Carry into digits 4-7
+  dec     R11         ; decrement loop counter
+  jnz     bin2bcd32H  ; LOOP
+                      ; R11 is now 0, use it for digits 8-9
+  mov     #16,R13     ; high word is used up, reuse as loop counter
+bin2bcd32L:
+  rla.w   R12         ; Loads highest bit of low word into C
+  dadd.w  R14, R14    ; BCD routine
+  dadd.w  R15, R15    ; Carry into digits 4-7
+  dadd.w  R11, R11    ; Carry into digits 8-9
+  dec     R13         ; decrement loop counter
+  jnz     bin2bcd32L  ; LOOP
+  mov     R14,R12     ; Digits 0-3
+  mov     R15,R13     ; Digits 4-7
+  mov     R11,R14     ; Digits 8-9
+  mov     #0,R15
+  ret
+
+; *****************************************************************************
+; bin2bcd8_unrolled
+; Same as bin2bcd8, with the loop unrolled to drop the dec/jnz from each bit.
+; Cycles: 21, plus 5 for the call.
+; *****************************************************************************
+
+  .global bin2bcd8_unrolled
+
+bin2bcd8_unrolled:
+  mov     #0,R13      ; BCD result
+  rla.b   R12         ; Bit 7
+  dadd.w  R13, R13
+  rla.b   R12         ; Bit 6
+  dadd.w  R13, R13
+  rla.b   R12         ; Bit 5
+  dadd.w  R13, R13
+  rla.b   R12         ; Bit 4
+  dadd.w  R13, R13
+  rla.b   R12         ; Bit 3
+  dadd.w  R13, R13
+  rla.b   R12         ; Bit 2
+  dadd.w  R13, R13
+  rla.b   R12         ; Bit 1
+  dadd.w  R13, R13
+  rla.b   R12         ; Bit 0
+  dadd.w  R13, R13
+  mov     R13,R12     ; Put result in R12
+  ret
+
+; *****************************************************************************
+; bin2bcd16_unrolled
+; Same as bin2bcd16, with the loop unrolled to drop the dec/jnz from each bit.
+; Still only 4 digits, so anything over 9999 will not convert properly.
+; Cycles: 37, plus 5 for the call.
+; *****************************************************************************
+
+  .global bin2bcd16_unrolled
 
+bin2bcd16_unrolled:
+  mov     #0,R13      ; BCD result
+  rla.w   R12         ; Bit 15
+  dadd.w  R13, R13
+  rla.w   R12         ; Bit 14
+  dadd.w  R13, R13
+  rla.w   R12         ; Bit 13
+  dadd.w  R13, R13
+  rla.w   R12         ; Bit 12
+  dadd.w  R13, R13
+  rla.w   R12         ; Bit 11
+  dadd.w  R13, R13
+  rla.w   R12         ; Bit 10
+  dadd.w  R13, R13
+  rla.w   R12         ; Bit 9
+  dadd.w  R13, R13
+  rla.w   R12         ; Bit 8
+  dadd.w  R13, R13
+  rla.w   R12         ; Bit 7
+  dadd.w  R13, R13
+  rla.w   R12         ; Bit 6
+  dadd.w  R13, R13
+  rla.w   R12         ; Bit 5
+  dadd.w  R13, R13
+  rla.w   R12         ; Bit 4
+  dadd.w  R13, R13
+  rla.w   R12         ; Bit 3
+  dadd.w  R13, R13
+  rla.w   R12         ; Bit 2
+  dadd.w  R13, R13
+  rla.w   R12         ; Bit 1
+  dadd.w  R13, R13
+  rla.w   R12         ; Bit 0
+  dadd.w  R13, R13
+  mov     R13,R12     ; Put result in R12
+  ret
+
+; *****************************************************************************
+; bcd2bin8
+; Takes in a 2-digit packed BCD byte and converts it to binary (0-99).
+; tens * 10 is built as (tens * 16) / 2 + (tens * 16) / 8, so no multiply.
+; Cycles: 13, plus 5 for the call.
+; *****************************************************************************
+
+  .global bcd2bin8
+
+bcd2bin8:
+  mov.b   R12,R13     ; R13 = packed BCD
+  and.b   #0x0F,R12   ; R12 = ones digit
+  and.b   #0xF0,R13   ; R13 = tens * 16
+  rra.w   R13         ; tens * 8
+  add.w   R13,R12
+  rra.w   R13
+  rra.w   R13         ; tens * 2
+  add.w   R13,R12     ; R12 = ones + tens * 10
+  ret
+
+; *****************************************************************************
+; bcd2bin16
+; Takes in a 4-digit packed BCD word and converts it to binary (0-9999).
+; Each byte is converted like bcd2bin8, then the upper pair is multiplied by
+; 100 as 64 + 32 + 4 with shifts.
+; Cycles: 35, plus 5 for the call.
+; *****************************************************************************
+
+  .global bcd2bin16
+
+bcd2bin16:
+  mov.w   R12,R14     ; Upper two digits
+  swpb    R14         ; ...into the low byte
+  mov.b   R14,R13
+  and.b   #0x0F,R14   ; R14 = hundreds digit
+  and.b   #0xF0,R13   ; R13 = thousands * 16
+  rra.w   R13         ; thousands * 8
+  add.w   R13,R14
+  rra.w   R13
+  rra.w   R13         ; thousands * 2
+  add.w   R13,R14     ; R14 = upper pair in binary (0-99)
+  rla.w   R14
+  rla.w   R14         ; upper * 4
+  mov.w   R14,R13
+  rla.w   R14
+  rla.w   R14
+  rla.w   R14         ; upper * 32
+  add.w   R14,R13     ; upper * 36
+  rla.w   R14         ; upper * 64
+  add.w   R14,R13     ; R13 = upper * 100
+  mov.b   R12,R15     ; Lower two digits
+  and.b   #0x0F,R12   ; R12 = ones digit
+  and.b   #0xF0,R15   ; R15 = tens * 16
+  rra.w   R15         ; tens * 8
+  add.w   R15,R12
+  rra.w   R15
+  rra.w   R15         ; tens * 2
+  add.w   R15,R12     ; R12 = lower pair in binary (0-99)
+  add.w   R13,R12     ; Add in upper * 100
+  ret
@@ -0,0 +1,221 @@
+/*
+ * @file CRC.h
+ * @brief Table, nibble and bitwise CRC-16/MODBUS, CRC-16/CCITT and CRC-8
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-14
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @details
+ * Every CRC has a per-byte update, for running a checksum in an RX ISR as
+ * bytes come in, and a block version for frames already in memory. Start
+ * from the matching CRC*_INIT value.
+ *
+ * | Name         | Poly   | Init   | Reflected | "123456789" |
+ * |--------------|--------|--------|-----------|-------------|
+ * | CRC16_Modbus | 0x8005 | 0xFFFF | yes       | 0x4B37      |
+ * | CRC16_CCITT  | 0x1021 | 0xFFFF | no        | 0x29B1      |
+ * | CRC8         | 0x07   | 0x00   | no        | 0xF4        |
+ *
+ * None of them XOR the result on the way out, so running the CRC over a
+ * frame with its own CRC on the end gives 0. Modbus sends its CRC low byte
+ * first, CCITT high byte first.
+ *
+ * Set CRC_METHOD to trade flash against speed:
+ *
+ * - CRC_METHOD_TABLE: one lookup per byte. 512 bytes of tables for each
+ *   16-bit CRC, 256 for CRC8.
+ * - CRC_METHOD_NIBBLE: two lookups per byte. 32 bytes of tables for each
+ *   16-bit CRC, 16 for CRC8. The default.
+ * - CRC_METHOD_BITWISE: eight shifts per byte, no tables.
+ *
+ * Only the tables for CRCs that are actually called get linked in, as long
+ * as the linker drops unused sections (-ffunction-sections -fdata-sections
+ * -Wl,--gc-sections).
+ *
+ * Where the part has a CRC16 module (__MSP430_HAS_CRC__), CRC16_CCITT uses
+ * it whatever CRC_METHOD says. Define CRC_NO_HARDWARE to stop that. The
+ * module holds only one running CRC, so each update reloads it with the
+ * caller's value. Even so, don't use CRC16_CCITT in an ISR and the main loop
+ * at once unless the main loop disables interrupts around it.
+ *
+ * Running a CRC in an RX ISR is set up in the driver: see UARTA0_RX_CRC and
+ * RS485A_RX_CRC.
+ */
+
+#ifndef CRC_H_
+#define CRC_H_
+
+#include <msp430.h>
+#include <stdint.h>
+
+/// @name CRC_METHOD values
+/// @{
+#define CRC_METHOD_TABLE    0 ///< 256-entry tables, fastest
+#define CRC_METHOD_NIBBLE   1 ///< 16-entry tables
+#define CRC_METHOD_BITWISE  2 ///< No tables, smallest
+/// @}
+
+#ifndef CRC_METHOD
+#define CRC_METHOD  CRC_METHOD_NIBBLE
+#endif
+
+#if defined(__MSP430_HAS_CRC__) && !defined(CRC_NO_HARDWARE)
+#define CRC_HARDWARE
+#endif
+
+/// @name Initial values
+/// @{
+#define CRC16_MODBUS_INIT  0xFFFF
+#define CRC16_CCITT_INIT   0xFFFF
+#define CRC8_INIT          0x00
+/// @}
+
+#if CRC_METHOD == CRC_METHOD_TABLE
+extern const uint16_t CRC16_modbus_table[256];
+extern const uint16_t CRC16_ccitt_table[256];
+extern const uint8_t CRC8_table[256];
+#elif CRC_METHOD == CRC_METHOD_NIBBLE
+extern const uint16_t CRC16_modbus_table[16];
+extern const uint16_t CRC16_ccitt_table[16];
+extern const uint8_t CRC8_table[16];
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Add one byte to a CRC-16/MODBUS.
+ * @param crc CRC so far, or CRC16_MODBUS_INIT.
+ * @param data Next byte.
+ * @returns The updated CRC.
+ */
+static inline uint16_t CRC16_Modbus_Update(uint16_t crc, uint8_t data)
+{
+#if CRC_METHOD == CRC_METHOD_TABLE
+  return (crc >> 8) ^ CRC16_modbus_table[(uint8_t)crc ^ data];
+#elif CRC_METHOD == CRC_METHOD_NIBBLE
+  crc ^= data;
+  crc = (crc >> 4) ^ CRC16_modbus_table[crc & 0x0F];
+  return (crc >> 4) ^ CRC16_modbus_table[crc & 0x0F];
+#else
+  uint8_t i;
+
+  crc ^= data;
+  for (i = 8; i > 0; i--)
+  {
+    crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : (crc >> 1);
+  }
+  return crc;
+#endif
+}
+
+/*
+ * Add one byte to a CRC-16/CCITT.
+ * @param crc CRC so far, or CRC16_CCITT_INIT.
+ * @param data Next byte.
+ * @returns The updated CRC.
+ */
+static inline uint16_t CRC16_CCITT_Update(uint16_t crc, uint8_t data)
+{
+#if defined(CRC_HARDWARE)
+  CRCINIRES = crc;
+  CRCDIRB_L = data;   // Bit-reversed input register gives the MSB-first CRC
+  return CRCINIRES;
+#elif CRC_METHOD == CRC_METHOD_TABLE
+  return (crc << 8) ^ CRC16_ccitt_table[(crc >> 8) ^ data];
+#elif CRC_METHOD == CRC_METHOD_NIBBLE
+  crc = (crc << 4) ^ CRC16_ccitt_table[(crc >> 12) ^ (data >> 4)];
+  return (crc << 4) ^ CRC16_ccitt_table[(crc >> 12) ^ (data & 0x0F)];
+#else
+  uint8_t i;
+
+  crc ^= (uint16_t)data << 8;
+  for (i = 8; i > 0; i--)
+  {
+    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+  }
+  return crc;
+#endif
+}
+
+/*
+ * Add one byte to a CRC-8.
+ * @param crc CRC so far, or CRC8_INIT.
+ * @param data Next byte.
+ * @returns The updated CRC.
+ */
+static inline uint8_t CRC8_Update(uint8_t crc, uint8_t data)
+{
+#if CRC_METHOD == CRC_METHOD_TABLE
+  return CRC8_table[crc ^ data];
+#elif CRC_METHOD == CRC_METHOD_NIBBLE
+  crc ^= data;
+  crc = (crc << 4) ^ CRC8_table[crc >> 4];
+  return (crc << 4) ^ CRC8_table[crc >> 4];
+#else
+  uint8_t i;
+
+  crc ^= data;
+  for (i = 8; i > 0; i--)
+  {
+    crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+  }
+  return crc;
+#endif
+}
+
+/*
+ * Run a CRC-16/MODBUS over a block of bytes.
+ * @param crc CRC so far, or CRC16_MODBUS_INIT.
+ * @param data Bytes to add.
+ * @param len Number of bytes.
+ * @returns The updated CRC.
+ */
+uint16_t CRC16_Modbus(uint16_t crc, const uint8_t *data, uint16_t len);
+
+/*
+ * Run a CRC-16/CCITT over a block of bytes.
+ * @param crc CRC so far, or CRC16_CCITT_INIT.
+ * @param data Bytes to add.
+ * @param len Number of bytes.
+ * @returns The updated CRC.
+ */
+uint16_t CRC16_CCITT(uint16_t crc, const uint8_t *data, uint16_t len);
+
+/*
+ * Run a CRC-8 over a block of bytes.
+ * @param crc CRC so far, or CRC8_INIT.
+ * @param data Bytes to add.
+ * @param len Number of bytes.
+ * @returns The updated CRC.
+ */
+uint8_t CRC8(uint8_t crc, const uint8_t *data, uint16_t len);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CRC_H_ */
@@ -0,0 +1,139 @@
+/*
+ * @file Filter.c
+ * @brief Integer-only filtering for ADC10 samples
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-02
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include "Filter.h"
+
+uint16_t Filter_Decimate(
+    const uint16_t *in,
+    uint16_t len,
+    uint16_t *out,
+    uint8_t extra_bits)
+{
+  uint16_t group;
+  uint16_t written = 0;
+  uint32_t acc;
+  uint16_t i;
+
+  // Past 6 the group no longer fits in 16 bits, nor its sum in 32
+  if (extra_bits > 6)
+  {
+    return 0;
+  }
+  group = 1 << (extra_bits << 1);  // 4^extra_bits
+  while (len >= group)
+  {
+    len -= group;
+    // 16-bit accumulator is enough for up to 64 10-bit samples
+    if (extra_bits <= 3)
+    {
+      uint16_t acc16 = 0;
+      for (i = group; i > 0; i--)
+      {
+        acc16 += *in++;
+      }
+      acc = acc16;
+    } else {
+      acc = 0;
+      for (i = group; i > 0; i--)
+      {
+        acc += *in++;
+      }
+    }
+    *out++ = (uint16_t)(acc >> extra_bits);
+    written++;
+  }
+  return written;
+}
+
+void Filter_Boxcar_Init(
+    Filter_Boxcar *f,
+    uint16_t *history,
+    uint8_t shift,
+    uint16_t initial)
+{
+  uint16_t i;
+
+  f->history = history;
+  f->shift = shift;
+  f->index = 0;
+  for (i = 0; i < (1 << shift); i++)
+  {
+    history[i] = initial;
+  }
+  f->sum = (uint32_t)initial << shift;
+}
+
+void Filter_Boxcar_Block(
+    Filter_Boxcar *f,
+    const uint16_t *in,
+    uint16_t *out,
+    uint16_t len)
+{
+  // Keep the filter state in locals so it can live in registers
+  uint16_t *history = f->history;
+  uint32_t sum = f->sum;
+  const uint8_t shift = f->shift;
+  const uint8_t mask = (1 << shift) - 1;
+  uint8_t index = f->index;
+  uint16_t sample;
+
+  while (len--)
+  {
+    sample = *in++;
+    sum -= history[index];
+    sum += sample;
+    history[index] = sample;
+    index = (index + 1) & mask;
+    *out++ = (uint16_t)(sum >> shift);
+  }
+
+  f->sum = sum;
+  f->index = index;
+}
+
+void Filter_IIR_Block(
+    Filter_IIR *f,
+    const uint16_t *in,
+    uint16_t *out,
+    uint16_t len)
+{
+  uint32_t state = f->state;
+  const uint8_t shift = f->shift;
+
+  while (len--)
+  {
+    state -= state >> shift;
+    state += *in++;
+    *out++ = (uint16_t)(state >> shift);
+  }
+
+  f->state = state;
+}
@@ -0,0 +1,174 @@
+/*
+ * @file Filter.h
+ * @brief Integer-only filtering for ADC10 samples
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-02
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @details
+ * All filters work on blocks of unsigned samples, such as the ones returned by
+ * ADC10_AnalogReadBlock, and only use adds and shifts. Nothing here needs a
+ * hardware multiplier.
+ *
+ * - Filter_Decimate: accumulate 4^n samples and shift right by n to gain n
+ *   extra bits of resolution. Only useful if the input has at least 1 LSB of
+ *   noise on it.
+ * - Filter_Boxcar: moving average over 2^n samples, kept as a running sum so
+ *   each sample costs one add and one subtract.
+ * - Filter_IIR: single-pole low-pass, y += (x - y) / 2^k. The state keeps k
+ *   extra fractional bits so small steps are not lost to truncation.
+ */
+
+#ifndef FILTER_H_
+#define FILTER_H_
+
+#include <stdint.h>
+
+struct filter_boxcar_t {
+	uint16_t *history;  // Last 2^shift input samples
+	uint32_t sum;       // Running sum of history
+	uint8_t shift;      // log2 of the window length
+	uint8_t index;      // Next history slot to overwrite
+};
+
+typedef struct filter_boxcar_t Filter_Boxcar;
+
+struct filter_iir_t {
+	uint32_t state;     // Filter output, scaled up by 2^shift
+	uint8_t shift;      // Filter coefficient is 1/2^shift
+};
+
+typedef struct filter_iir_t Filter_IIR;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Oversample and decimate a block of samples.
+ * Every 4^extra_bits input samples produce one output sample that is
+ * extra_bits wider than the input (a 10-bit ADC10 result with extra_bits = 2
+ * becomes a 12-bit result). Leftover samples at the end of the block that
+ * don't make up a full group are ignored.
+ * @param in Block of input samples.
+ * @param len Number of samples in the block.
+ * @param out Output block, must hold len >> (2 * extra_bits) samples.
+ * @param extra_bits Number of bits of resolution to add (0 to 6).
+ * @returns Number of samples written to out, or 0 if extra_bits is over 6.
+ */
+uint16_t Filter_Decimate(
+    const uint16_t *in,
+    uint16_t len,
+    uint16_t *out,
+    uint8_t extra_bits);
+
+/**
+ * Set up a moving average filter.
+ * Every slot of the history is set to initial, and the running sum to
+ * initial times the window length. Passing the first sample as initial
+ * means the output doesn't have to ramp up from zero.
+ * @param f Filter to set up.
+ * @param history Buffer for the window, must hold 2^shift samples.
+ * @param shift log2 of the window length (0 to 8).
+ * @param initial Value to fill the window with.
+ */
+void Filter_Boxcar_Init(
+    Filter_Boxcar *f,
+    uint16_t *history,
+    uint8_t shift,
+    uint16_t initial);
+
+/**
+ * Run one sample through a moving average filter.
+ * @param f Filter to update.
+ * @param sample New input sample.
+ * @returns The average of the last 2^shift samples.
+ */
+static inline uint16_t Filter_Boxcar_Step(Filter_Boxcar *f, uint16_t sample)
+{
+	f->sum -= f->history[f->index];
+	f->sum += sample;
+	f->history[f->index] = sample;
+	f->index = (f->index + 1) & ((1 << f->shift) - 1);
+	return (uint16_t)(f->sum >> f->shift);
+}
+
+/**
+ * Run a block of samples through a moving average filter.
+ * @param f Filter to update.
+ * @param in Block of input samples.
+ * @param out Block of output samples, may be the same as in.
+ * @param len Number of samples in the block.
+ */
+void Filter_Boxcar_Block(
+    Filter_Boxcar *f,
+    const uint16_t *in,
+    uint16_t *out,
+    uint16_t len);
+
+/**
+ * Set up a single-pole IIR low-pass filter.
+ * The time constant is roughly 2^shift samples.
+ * @param f Filter to set up.
+ * @param shift Filter coefficient is 1/2^shift (0 to 15).
+ * @param initial Starting output value.
+ */
+static inline void Filter_IIR_Init(Filter_IIR *f, uint8_t shift, uint16_t initial)
+{
+	f->shift = shift;
+	f->state = (uint32_t)initial << shift;
+}
+
+/**
+ * Run one sample through a single-pole IIR filter.
+ * @param f Filter to update.
+ * @param sample New input sample.
+ * @returns The new filter output.
+ */
+static inline uint16_t Filter_IIR_Step(Filter_IIR *f, uint16_t sample)
+{
+	f->state -= f->state >> f->shift;
+	f->state += sample;
+	return (uint16_t)(f->state >> f->shift);
+}
+
+/**
+ * Run a block of samples through a single-pole IIR filter.
+ * @param f Filter to update.
+ * @param in Block of input samples.
+ * @param out Block of output samples, may be the same as in.
+ * @param len Number of samples in the block.
+ */
+void Filter_IIR_Block(
+    Filter_IIR *f,
+    const uint16_t *in,
+    uint16_t *out,
+    uint16_t len);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FILTER_H_ */
@@ -0,0 +1,176 @@
+/**
+ * @file	Format.c
+ * Number to ASCII formatting built on the BCDConv routines.
+ *
+ * @author	Scott Teal
+ * @date	May 6, 2014
+ * @copyright
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Cognoscan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Includes
+// ========
+#include <stdint.h>
+#include <stdbool.h>
+#include "BCDConv.h"	// Binary to BCD Conversion functions
+#include "Format.h"		// Formatting Library (which this file defines)
+
+/**
+ * Write out a BCD value as ASCII.
+ * Digits are taken from the low nibble up and written from the end of the
+ * field backwards, so only fixed 4-bit shifts are needed.
+ * @param	buf			Output buffer.
+ * @param	low			BCD digits 0-7.
+ * @param	high		BCD digits 8-9.
+ * @param	neg			Prefix with a minus sign.
+ * @param	decimals	Number of digits after the decimal point.
+ * @param	width		Minimum field width.
+ * @param	pad			Padding character.
+ * @return	Number of characters written.
+ */
+static uint8_t Fmt_BCD(char *buf, uint32_t low, uint16_t high, bool neg,
+		uint8_t decimals, uint8_t width, char pad)
+{
+	uint8_t digits = 0;
+	uint8_t len;
+	uint8_t i;
+	uint32_t t;
+	char *p;
+
+	// Count significant digits
+	if (high)
+	{
+		digits = 8;
+		for (t = high; t; t >>= 4)
+		{
+			digits++;
+		}
+	} else {
+		for (t = low; t; t >>= 4)
+		{
+			digits++;
+		}
+	}
+	if (digits <= decimals)
+	{
+		digits = decimals + 1;				// Always a digit before the point
+	}
+
+	len = digits + neg + (decimals ? 1 : 0);
+	if (width > len)
+	{
+		len = width;
+	}
+
+	// Digits, from the end of the field back
+	p = buf + len;
+	*p = '\0';
+	for (i = 0; i < digits; i++)
+	{
+		if (decimals && (i == decimals))
+		{
+			*--p = '.';
+		}
+		if (i == 8)
+		{
+			low = high;
+		}
+		*--p = '0' + (low & 0x0F);
+		low >>= 4;
+	}
+
+	// Sign and padding. Zeros go between the sign and digits, spaces before.
+	if (pad == FMT_PAD_ZERO)
+	{
+		while (p > buf + neg)
+		{
+			*--p = '0';
+		}
+		if (neg)
+		{
+			*--p = '-';
+		}
+	} else {
+		if (neg)
+		{
+			*--p = '-';
+		}
+		while (p > buf)
+		{
+			*--p = pad;
+		}
+	}
+	return len;
+}
+
+uint8_t Fmt_U8(char *buf, uint8_t val, uint8_t width, char pad)
+{
+	return Fmt_BCD(buf, bin2bcd8(val), 0, false, 0, width, pad);
+}
+
+uint8_t Fmt_S8(char *buf, int8_t val, uint8_t width, char pad)
+{
+	bool neg = (val < 0);
+	uint8_t mag = neg ? -(uint8_t)val : (uint8_t)val;
+	return Fmt_BCD(buf, bin2bcd8(mag), 0, neg, 0, width, pad);
+}
+
+uint8_t Fmt_U16(char *buf, uint16_t val, uint8_t width, char pad)
+{
+	return Fmt_BCD(buf, bin2bcd16l(val), 0, false, 0, width, pad);
+}
+
+uint8_t Fmt_S16(char *buf, int16_t val, uint8_t width, char pad)
+{
+	return Fmt_Fixed16(buf, val, 0, width, pad);
+}
+
+uint8_t Fmt_U32(char *buf, uint32_t val, uint8_t width, char pad)
+{
+	uint64_t bcd = bin2bcd32(val);
+	return Fmt_BCD(buf, (uint32_t)bcd, (uint16_t)(bcd >> 32), false, 0,
+			width, pad);
+}
+
+uint8_t Fmt_S32(char *buf, int32_t val, uint8_t width, char pad)
+{
+	return Fmt_Fixed32(buf, val, 0, width, pad);
+}
+
+uint8_t Fmt_Fixed16(char *buf, int16_t val, uint8_t decimals, uint8_t width,
+		char pad)
+{
+	bool neg = (val < 0);
+	uint16_t mag = neg ? -(uint16_t)val : (uint16_t)val;
+	return Fmt_BCD(buf, bin2bcd16l(mag), 0, neg, decimals, width, pad);
+}
+
+uint8_t Fmt_Fixed32(char *buf, int32_t val, uint8_t decimals, uint8_t width,
+		char pad)
+{
+	bool neg = (val < 0);
+	uint32_t mag = neg ? -(uint32_t)val : (uint32_t)val;
+	uint64_t bcd = bin2bcd32(mag);
+	return Fmt_BCD(buf, (uint32_t)bcd, (uint16_t)(bcd >> 32), neg, decimals,
+			width, pad);
+}
@@ -0,0 +1,125 @@
+/**
+ * @file	Format.h
+ * Number to ASCII formatting built on the BCDConv routines.
+ * Values are converted to BCD with bin2bcd8/bin2bcd16l/bin2bcd32, then the
+ * nibbles are turned into characters directly. There is no division anywhere,
+ * so formatting costs about the same on parts without a hardware multiplier.
+ *
+ * Every function writes into a caller-supplied buffer, null terminates it, and
+ * returns the number of characters written (not counting the terminator). The
+ * buffer must hold at least the larger of width and the longest possible
+ * result, plus one for the terminator:
+ *
+ *  - 8-bit:  3 digits + sign
+ *  - 16-bit: 5 digits + sign
+ *  - 32-bit: 10 digits + sign
+ *  - fixed point adds one for the decimal point.
+ *
+ * @author	Scott Teal
+ * @date	May 6, 2014
+ * @copyright
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Cognoscan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FORMAT_H_
+#define FORMAT_H_
+
+#include <stdint.h>
+
+/// @name Padding characters
+/// @{
+#define FMT_PAD_SPACE ' '	///< Right-align with leading spaces
+#define FMT_PAD_ZERO  '0'	///< Right-align with leading zeros, after the sign
+/// @}
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Format an unsigned 8-bit value in decimal.
+ * @param	buf		Output buffer.
+ * @param	val		Value to format.
+ * @param	width	Minimum field width. Use 0 for no padding.
+ * @param	pad		Padding character, FMT_PAD_SPACE or FMT_PAD_ZERO.
+ * @return	Number of characters written.
+ */
+uint8_t Fmt_U8(char *buf, uint8_t val, uint8_t width, char pad);
+
+/**
+ * Format a signed 8-bit value in decimal.
+ * @see Fmt_U8
+ */
+uint8_t Fmt_S8(char *buf, int8_t val, uint8_t width, char pad);
+
+/**
+ * Format an unsigned 16-bit value in decimal.
+ * @see Fmt_U8
+ */
+uint8_t Fmt_U16(char *buf, uint16_t val, uint8_t width, char pad);
+
+/**
+ * Format a signed 16-bit value in decimal.
+ * @see Fmt_U8
+ */
+uint8_t Fmt_S16(char *buf, int16_t val, uint8_t width, char pad);
+
+/**
+ * Format an unsigned 32-bit value in decimal.
+ * @see Fmt_U8
+ */
+uint8_t Fmt_U32(char *buf, uint32_t val, uint8_t width, char pad);
+
+/**
+ * Format a signed 32-bit value in decimal.
+ * @see Fmt_U8
+ */
+uint8_t Fmt_S32(char *buf, int32_t val, uint8_t width, char pad);
+
+/**
+ * Format a signed 16-bit fixed-point value.
+ * The value is in units of 10^-decimals, so Fmt_Fixed16(buf, -1234, 2, 0, ' ')
+ * gives "-12.34". There is always at least one digit before the point.
+ * @param	buf			Output buffer.
+ * @param	val			Value to format.
+ * @param	decimals	Number of digits after the decimal point (0 to 4).
+ * @param	width		Minimum field width. Use 0 for no padding.
+ * @param	pad			Padding character, FMT_PAD_SPACE or FMT_PAD_ZERO.
+ * @return	Number of characters written.
+ */
+uint8_t Fmt_Fixed16(char *buf, int16_t val, uint8_t decimals, uint8_t width,
+		char pad);
+
+/**
+ * Format a signed 32-bit fixed-point value.
+ * @param	decimals	Number of digits after the decimal point (0 to 9).
+ * @see Fmt_Fixed16
+ */
+uint8_t Fmt_Fixed32(char *buf, int32_t val, uint8_t decimals, uint8_t width,
+		char pad);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FORMAT_H_ */
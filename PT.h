@@ -0,0 +1,118 @@
+/*
+ * @file PT.h
+ * @brief Stackless protothreads
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-13
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @details
+ * A protothread is a function that can wait part way through and carry on
+ * from the same place the next time it is called. The place is kept in a
+ * 16-bit PT record, so a thread costs two bytes of RAM and needs no stack of
+ * its own. It works by turning the function body into a switch statement on
+ * the line number it stopped at, which has a few consequences:
+ *
+ *  - Local variables are not kept across a wait. Keep anything needed
+ *    afterwards in a static, or in the task record.
+ *  - A switch statement can't span a wait.
+ *  - Only one wait can be on a line, so the wait macros can't be wrapped in
+ *    another macro more than once.
+ *
+ * ~~~{.c}
+ * PT_THREAD(Echo(PT *pt))
+ * {
+ *   static uint8_t c;
+ *
+ *   PT_BEGIN(pt);
+ *   while (1) {
+ *     PT_WAIT_UNTIL(pt, !UARTA0_Empty());
+ *     c = UARTA0_Receive();
+ *     PT_WAIT_UNTIL(pt, UARTA0_TrySend(c));
+ *   }
+ *   PT_END(pt);
+ * }
+ * ~~~
+ */
+
+#ifndef PT_H_
+#define PT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+struct pt_t {
+  uint16_t lc;                    // Line to carry on from, or 0 to start
+};
+
+typedef struct pt_t PT;
+
+/// @name Protothread return values
+/// @{
+#define PT_WAITING  0   ///< Blocked waiting on a condition
+#define PT_YIELDED  1   ///< Gave up the CPU, but can carry on
+#define PT_EXITED   2   ///< Stopped with PT_EXIT
+#define PT_ENDED    3   ///< Ran off the end
+/// @}
+
+/// Reset a protothread to start from the beginning
+#define PT_INIT(pt) ((pt)->lc = 0)
+
+/// Declare a protothread function
+#define PT_THREAD(name_args) uint8_t name_args
+
+/// Start of the protothread body
+#define PT_BEGIN(pt) { bool pt_yielded = true; (void)pt_yielded; \
+  switch ((pt)->lc) { case 0:
+
+/// End of the protothread body
+#define PT_END(pt) } pt_yielded = false; PT_INIT(pt); return PT_ENDED; }
+
+/// Wait until a condition is true. The condition is checked straight away.
+#define PT_WAIT_UNTIL(pt, cond) do { \
+  (pt)->lc = __LINE__; case __LINE__: \
+  if (!(cond)) { return PT_WAITING; } } while (0)
+
+/// Wait while a condition is true
+#define PT_WAIT_WHILE(pt, cond) PT_WAIT_UNTIL(pt, !(cond))
+
+/// Wait for a child protothread to finish
+#define PT_WAIT_THREAD(pt, thread) PT_WAIT_WHILE(pt, PT_SCHEDULE(thread))
+
+/// Give up the CPU once, letting other tasks run
+#define PT_YIELD(pt) do { \
+  pt_yielded = false; \
+  (pt)->lc = __LINE__; case __LINE__: \
+  if (!pt_yielded) { return PT_YIELDED; } } while (0)
+
+/// Restart the protothread from the beginning on the next call
+#define PT_RESTART(pt) do { PT_INIT(pt); return PT_WAITING; } while (0)
+
+/// Stop the protothread
+#define PT_EXIT(pt) do { PT_INIT(pt); return PT_EXITED; } while (0)
+
+/// True if a protothread call returned and it hasn't finished
+#define PT_SCHEDULE(f) ((f) < PT_EXITED)
+
+#endif /* PT_H_ */
@@ -0,0 +1,161 @@
+/**
+ * @file	Parse.c
+ * Incremental ASCII number parser.
+ *
+ * @author	Scott Teal
+ * @date	May 8, 2014
+ * @copyright
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Cognoscan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Includes
+// ========
+#include <stdint.h>
+#include "BCDConv.h"	// BCD to binary conversion functions
+#include "Parse.h"		// Number Parser (which this file defines)
+
+/// Largest value that can be multiplied by 10 without overflowing 32 bits
+#define PARSE_MAX_DIV10  429496729UL
+
+void Parse_Init(Parse_State *p)
+{
+	p->value = 0;
+	p->bcd = 0;
+	p->digits = 0;
+	p->flags = 0;
+}
+
+/**
+ * Mark the parser as finished.
+ * @param	p		The parser state.
+ * @param	status	PARSE_DONE or PARSE_ERROR.
+ * @return	status
+ */
+static uint8_t Parse_End(Parse_State *p, uint8_t status)
+{
+	p->flags |= PARSE_END;
+	return status;
+}
+
+uint8_t Parse_Byte(Parse_State *p, uint8_t c)
+{
+	uint8_t d;
+
+	if (p->flags & PARSE_END)
+	{
+		return PARSE_ERROR;
+	}
+
+	switch (c)
+	{
+		// Whitespace before the number is skipped, anywhere else it ends it
+		case ' ':
+		case '\t':
+			if ((p->digits == 0) && !(p->flags & (PARSE_NEG | PARSE_HEX)))
+			{
+				return PARSE_MORE;
+			}
+			// Fall through
+		case ',':
+		case ';':
+		case '\r':
+		case '\n':
+		case '\0':
+			if (p->digits == 0)
+			{
+				return Parse_End(p, PARSE_ERROR);
+			}
+			if (!(p->flags & (PARSE_HEX | PARSE_BIN)))
+			{
+				p->value = bcd2bin16(p->bcd);
+			}
+			return Parse_End(p, PARSE_DONE);
+
+		case '-':
+			if ((p->digits != 0) || (p->flags & (PARSE_NEG | PARSE_HEX)))
+			{
+				return Parse_End(p, PARSE_ERROR);
+			}
+			p->flags |= PARSE_NEG;
+			return PARSE_MORE;
+
+		// Only valid right after a single leading '0'
+		case 'x':
+		case 'X':
+			if ((p->digits != 1) || (p->bcd != 0)
+					|| (p->flags & (PARSE_NEG | PARSE_HEX)))
+			{
+				return Parse_End(p, PARSE_ERROR);
+			}
+			p->flags |= PARSE_HEX;
+			p->digits = 0;
+			return PARSE_MORE;
+	}
+
+	if (p->flags & PARSE_HEX)
+	{
+		if ((c >= '0') && (c <= '9'))
+		{
+			d = c - '0';
+		} else {
+			d = (c | 0x20) - 'a' + 10;			// Fold to lower case
+			if ((d < 10) || (d > 15))
+			{
+				return Parse_End(p, PARSE_ERROR);
+			}
+		}
+		if (p->value & 0xF0000000UL)
+		{
+			return Parse_End(p, PARSE_ERROR);
+		}
+		p->value = (p->value << 4) | d;
+	} else {
+		if ((c < '0') || (c > '9'))
+		{
+			return Parse_End(p, PARSE_ERROR);
+		}
+		d = c - '0';
+		if (!(p->flags & PARSE_BIN) && (p->digits < 4))
+		{
+			p->bcd = (p->bcd << 4) | d;		// No conversion needed yet
+		} else {
+			if (!(p->flags & PARSE_BIN))
+			{
+				p->value = bcd2bin16(p->bcd);
+				p->flags |= PARSE_BIN;
+			}
+			if ((p->value > PARSE_MAX_DIV10)
+					|| ((p->value == PARSE_MAX_DIV10) && (d > 5)))
+			{
+				return Parse_End(p, PARSE_ERROR);
+			}
+			p->value = (p->value << 3) + (p->value << 1) + d;
+		}
+	}
+
+	if (p->digits < 255)
+	{
+		p->digits++;
+	}
+	return PARSE_MORE;
+}
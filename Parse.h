@@ -0,0 +1,143 @@
+/**
+ * @file	Parse.h
+ * Incremental ASCII number parser.
+ * Numbers are parsed one byte at a time, so a parameter can be pulled
+ * straight out of the RX stream (UARTA0_Receive, RS485A_Receive) without
+ * buffering the whole token first.
+ *
+ * Accepted forms are optional leading spaces, then either a decimal number
+ * with an optional '-' sign, or a hex number prefixed with "0x". The number
+ * ends at a space, tab, ',', ';', CR, LF, or '\0'. Anything else is an error.
+ *
+ * The first 4 decimal digits are collected as packed BCD with shifts only,
+ * and converted with bcd2bin16 at the end. Longer numbers switch over to
+ * shift-add (x * 10 = x * 8 + x * 2), so no multiply is ever needed.
+ *
+ * ~~~{.c}
+ * Parse_State p;
+ * uint8_t status;
+ *
+ * Parse_Init(&p);
+ * do {
+ *   while (UARTA0_Empty());
+ *   status = Parse_Byte(&p, UARTA0_Receive());
+ * } while (status == PARSE_MORE);
+ * if (status == PARSE_DONE) {
+ *   set_point = Parse_Signed(&p);
+ * }
+ * ~~~
+ *
+ * @author	Scott Teal
+ * @date	May 8, 2014
+ * @copyright
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Cognoscan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PARSE_H_
+#define PARSE_H_
+
+#include <stdint.h>
+
+/// @name Parse_Byte return values
+/// @{
+#define PARSE_MORE   0	///< Byte accepted, number not finished yet
+#define PARSE_DONE   1	///< Terminator seen, result is ready
+#define PARSE_ERROR  2	///< Bad character, overflow, or no digits
+/// @}
+
+/// @name Parse_State flags
+/// @{
+#define PARSE_NEG    0x01	///< Saw a '-' sign
+#define PARSE_HEX    0x02	///< Saw a "0x" prefix
+#define PARSE_BIN    0x04	///< Value has moved from bcd to binary
+#define PARSE_END    0x80	///< Finished, with or without error
+/// @}
+
+struct parse_state_t {
+	uint32_t value;		// Binary value, once past 4 decimal digits or hex
+	uint16_t bcd;		// Packed BCD of the first 4 decimal digits
+	uint8_t digits;		// Number of digits seen
+	uint8_t flags;		// PARSE_* flags
+};
+
+typedef struct parse_state_t Parse_State;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Reset the parser for a new number.
+ * @param	p	The parser state.
+ */
+void Parse_Init(Parse_State *p);
+
+/**
+ * Feed one byte into the parser.
+ * Once PARSE_DONE or PARSE_ERROR is returned, the parser must be
+ * reinitialized before the next number.
+ * @param	p	The parser state.
+ * @param	c	The next received byte.
+ * @return	PARSE_MORE, PARSE_DONE, or PARSE_ERROR.
+ */
+uint8_t Parse_Byte(Parse_State *p, uint8_t c);
+
+/**
+ * Get the parsed number as an unsigned value.
+ * Only valid after Parse_Byte returns PARSE_DONE.
+ * @param	p	The parser state.
+ */
+static inline uint32_t Parse_Unsigned(const Parse_State *p)
+{
+	return p->value;
+}
+
+/**
+ * Get the parsed number with its sign applied.
+ * Only valid after Parse_Byte returns PARSE_DONE. Numbers outside the
+ * int32_t range, -2147483648 to 2147483647, are clamped to the nearest end.
+ * @param	p	The parser state.
+ */
+static inline int32_t Parse_Signed(const Parse_State *p)
+{
+	if (p->flags & PARSE_NEG)
+	{
+		if (p->value > 2147483648UL)
+		{
+			return INT32_MIN;
+		}
+		// Negate unsigned, as -2147483648 has no positive int32_t
+		return (int32_t)(0u - p->value);
+	}
+	if (p->value > (uint32_t)INT32_MAX)
+	{
+		return INT32_MAX;
+	}
+	return (int32_t)p->value;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* PARSE_H_ */
@@ -0,0 +1,151 @@
+/*
+ * @file Profile.c
+ * @brief Cycle counting probes on a free-running Timer_A
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-14
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <msp430.h>
+#include <stdint.h>
+#include "Profile.h"
+
+#ifdef PROFILE_ENABLE
+
+#include "VT100.h"
+#include "Format.h"
+
+/// Width of the name column in Profile_Report
+#define PROFILE_NAME_WIDTH 10
+
+/// Width of each number column in Profile_Report
+#define PROFILE_COL_WIDTH 7
+
+Profile_Probe Profile_probes[PROFILE_PROBES];
+
+/// Cycles taken by an empty probe, taken off every result
+static uint16_t Profile_overhead;
+
+void Profile_Reset(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < PROFILE_PROBES; i++)
+  {
+    Profile_probes[i].count = 0;
+    Profile_probes[i].min = 0xFFFF;
+    Profile_probes[i].max = 0;
+    Profile_probes[i].total = 0;
+  }
+}
+
+void Profile_Init(void)
+{
+  PROFILE_TACTL = TASSEL_2 | MC_2 | TACLR;
+
+  // Time an empty probe, the same way any other one is timed
+  Profile_overhead = 0;
+  Profile_Reset();
+  PROFILE_BEGIN(0);
+  PROFILE_END(0);
+  Profile_overhead = Profile_probes[0].min;
+  Profile_Reset();
+}
+
+void Profile_Record(uint8_t id, uint16_t now)
+{
+  Profile_Probe *p = &Profile_probes[id];
+  uint16_t cycles = now - p->start;
+
+  if (p->count == 0xFFFF)
+  {
+    return;
+  }
+  // Don't wrap if the region came in under the calibrated probe cost
+  cycles = (cycles > Profile_overhead) ? cycles - Profile_overhead : 0;
+  p->count++;
+  p->total += cycles;
+  if (cycles < p->min)
+  {
+    p->min = cycles;
+  }
+  if (cycles > p->max)
+  {
+    p->max = cycles;
+  }
+}
+
+/**
+ * Print a number right-aligned in a report column.
+ * @param val The number.
+ */
+static void Profile_Column(uint16_t val)
+{
+  char buf[PROFILE_COL_WIDTH + 1];
+
+  Fmt_U16(buf, val, PROFILE_COL_WIDTH, FMT_PAD_SPACE);
+  VT_Print(buf);
+}
+
+void Profile_Report(uint8_t x, uint8_t y, const char * const *names)
+{
+  char buf[PROFILE_NAME_WIDTH + 1];
+  Profile_Probe *p;
+  uint8_t len;
+  uint8_t i;
+
+  VT_Goto(x, y);
+  VT_Print("Probe       Count    Min    Max    Avg");
+  for (i = 0; i < PROFILE_PROBES; i++)
+  {
+    p = &Profile_probes[i];
+    if (!p->count)
+    {
+      continue;
+    }
+    VT_Goto(x, ++y);
+    if (names)
+    {
+      for (len = 0; (len < PROFILE_NAME_WIDTH) && names[i][len]; len++)
+      {
+        buf[len] = names[i][len];
+      }
+    } else {
+      len = Fmt_U8(buf, i, 0, FMT_PAD_SPACE);
+    }
+    while (len < PROFILE_NAME_WIDTH)
+    {
+      buf[len++] = ' ';
+    }
+    buf[len] = '\0';
+    VT_Print(buf);
+    Profile_Column(p->count);
+    Profile_Column(p->min);
+    Profile_Column(p->max);
+    Profile_Column(p->total / p->count);
+  }
+}
+
+#endif /* PROFILE_ENABLE */
@@ -0,0 +1,161 @@
+/*
+ * @file Profile.h
+ * @brief Cycle counting probes on a free-running Timer_A
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-14
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @details
+ * Timer1_A free-runs from SMCLK, and each probe reads the counter at
+ * PROFILE_BEGIN and again at PROFILE_END. The difference, less the cost of
+ * the probes themselves, goes into a table of count/min/max/total per probe
+ * ID. With SMCLK undivided from MCLK, the figures are CPU cycles.
+ *
+ * Probes are only built in when PROFILE_ENABLE is defined. Otherwise the
+ * macros are empty, and Profile_Init and Profile_Report do nothing, so the
+ * probes can be left in the code.
+ *
+ * ~~~{.c}
+ * #define PROF_FIFO_PUT  0
+ * #define PROF_VT_POS    1
+ * #define PROF_RX_ISR    2
+ *
+ * const char * const prof_names[] = { "FIFO_Put", "VT_Pos", "RX lat." };
+ *
+ * PROFILE_BEGIN(PROF_FIFO_PUT);
+ * FIFO_Put(&fifo, c);
+ * PROFILE_END(PROF_FIFO_PUT);
+ *
+ * Profile_Report(1, 1, prof_names);
+ * ~~~
+ *
+ * Probes with the same ID must not nest, but different IDs can. A probe can
+ * begin in one place and end in another, so PROFILE_BEGIN where an interrupt
+ * is triggered and PROFILE_END at the top of its ISR measures the latency.
+ * Each probe has to end within 65535 cycles, about 4 ms at 16 MHz. A region
+ * quicker than an empty probe records 0.
+ */
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <msp430.h>
+#include <stdint.h>
+
+#ifndef PROFILE_PROBES
+#define PROFILE_PROBES 8    ///< Number of probe IDs
+#endif
+
+/// Counter the probes read. Timer1_A by default, since TimerA0.h has Timer0_A.
+#ifndef PROFILE_TAR
+#define PROFILE_TAR   TA1R
+#endif
+
+/// Control register of the timer PROFILE_TAR belongs to. Define it as well
+/// when PROFILE_TAR is changed, or Profile_Init starts the wrong timer.
+#ifndef PROFILE_TACTL
+#define PROFILE_TACTL TA1CTL
+#endif
+
+#ifdef PROFILE_ENABLE
+
+struct profile_probe_t {
+  uint16_t start;                 // Counter at PROFILE_BEGIN
+  uint16_t count;                 // Times recorded, stops at 0xFFFF
+  uint16_t min;                   // Fewest cycles
+  uint16_t max;                   // Most cycles
+  uint32_t total;                 // Sum of all cycles
+};
+
+typedef struct profile_probe_t Profile_Probe;
+
+/// Statistics for each probe ID
+extern Profile_Probe Profile_probes[PROFILE_PROBES];
+
+/// Start timing a probe
+#define PROFILE_BEGIN(id) (Profile_probes[id].start = PROFILE_TAR)
+
+/// Stop timing a probe and record the result
+#define PROFILE_END(id) Profile_Record((id), PROFILE_TAR)
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Start the counter running from SMCLK, measure the cost of an empty probe,
+ * and clear the table.
+ */
+void Profile_Init(void);
+
+/**
+ * Clear the table.
+ */
+void Profile_Reset(void);
+
+/**
+ * Record the end of a probe. Use PROFILE_END instead.
+ * @param id The probe ID.
+ * @param now The counter at the end of the probe.
+ */
+void Profile_Record(uint8_t id, uint16_t now);
+
+/**
+ * Draw the table with the VT100 layer. Each probe takes one row, with its
+ * count, min, max, and average cycles. Probes that haven't run are skipped.
+ * @param x Column of the top left corner.
+ * @param y Row of the top left corner.
+ * @param names Names of the probes, indexed by ID, or 0 to show the IDs.
+ */
+void Profile_Report(uint8_t x, uint8_t y, const char * const *names);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#else
+
+#define PROFILE_BEGIN(id) do { } while (0)
+#define PROFILE_END(id)   do { } while (0)
+
+static inline void Profile_Init(void)
+{
+}
+
+static inline void Profile_Reset(void)
+{
+}
+
+static inline void Profile_Report(uint8_t x, uint8_t y,
+    const char * const *names)
+{
+  (void)x;
+  (void)y;
+  (void)names;
+}
+
+#endif /* PROFILE_ENABLE */
+
+#endif /* PROFILE_H_ */
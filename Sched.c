@@ -0,0 +1,113 @@
+/*
+ * @file Sched.c
+ * @brief Cooperative run loop for protothread tasks
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-13
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <msp430.h>
+#include <stdint.h>
+#include "Sched.h"
+
+volatile bool Sched_pending;
+
+/// Running tasks. Empty slots are 0.
+static Sched_Task *Sched_tasks[SCHED_MAX_TASKS];
+
+bool Sched_Add(Sched_Task *task, uint8_t (*run)(Sched_Task *task))
+{
+  uint8_t i;
+
+  for (i = 0; i < SCHED_MAX_TASKS; i++)
+  {
+    if (!Sched_tasks[i])
+    {
+      PT_INIT(&task->pt);
+      task->run = run;
+      task->timer.active = false;
+      task->timeout = false;
+      Sched_tasks[i] = task;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Timer callback for Sched_Timeout.
+ * @param timer The timer at the start of a Sched_Task.
+ */
+static void Sched_TimerDone(TimerA0_Timer *timer)
+{
+  ((Sched_Task *)timer)->timeout = true;
+  Sched_pending = true;
+}
+
+void Sched_Timeout(Sched_Task *task, uint32_t ticks)
+{
+  task->timeout = false;
+  TimerA0_Start(&task->timer, ticks, 0, Sched_TimerDone);
+}
+
+void Sched_Run(void)
+{
+  Sched_Task *task;
+  uint8_t status;
+  uint8_t i;
+  bool busy;
+
+  while (1)
+  {
+    // Cleared before the tasks run, so an ISR during the pass keeps us awake
+    Sched_pending = false;
+    busy = false;
+    for (i = 0; i < SCHED_MAX_TASKS; i++)
+    {
+      task = Sched_tasks[i];
+      if (!task)
+      {
+        continue;
+      }
+      status = task->run(task);
+      if (status == PT_YIELDED)
+      {
+        busy = true;
+      } else if (status >= PT_EXITED) {
+        TimerA0_Stop(&task->timer);
+        Sched_tasks[i] = 0;
+      }
+    }
+
+    // Sleeping and enabling interrupts are one instruction, so a wake-up
+    // after the check can't be missed
+    __disable_interrupt();
+    if (!busy && !Sched_pending)
+    {
+      __bis_SR_register(SCHED_LPM_BITS | GIE);
+    }
+    __enable_interrupt();
+  }
+}
@@ -0,0 +1,171 @@
+/*
+ * @file Sched.h
+ * @brief Cooperative run loop for protothread tasks
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-13
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @details
+ * Each task is a protothread (see PT.h) run by Sched_Run. Tasks wait with
+ * PT_WAIT_UNTIL on the non-blocking driver calls (UARTA0_TrySend,
+ * RS485A_TrySend, ADC10_AnalogPoll, ADC10_TempPoll) or on a timer with
+ * SCHED_DELAY, so a task waiting on a slow consumer doesn't hold up the
+ * others. When every task is waiting, the CPU sleeps until an interrupt says
+ * something has changed.
+ *
+ * Any ISR that can unblock a task has to say so with SCHED_WAKE_ON_EXIT,
+ * otherwise the run loop may stay asleep:
+ *
+ * ~~~{.c}
+ * __attribute__((interrupt(USCIAB0RX_VECTOR)))
+ * void USCI_AB0_RX_ISR(void)
+ * {
+ * 	UARTA0_RX_ISR();
+ * 	SCHED_WAKE_ON_EXIT();
+ * }
+ *
+ * __attribute__((interrupt(USCIAB0TX_VECTOR)))
+ * void USCI_AB0_TX_ISR(void)
+ * {
+ * 	UARTA0_TX_ISR();
+ * 	SCHED_WAKE_ON_EXIT();
+ * }
+ *
+ * __attribute__((interrupt(TIMER0_A0_VECTOR)))
+ * void TIMER0_A0_ISR(void)
+ * {
+ * 	if (TimerA0_ISR())
+ * 		SCHED_WAKE_ON_EXIT();
+ * }
+ *
+ * __attribute__((interrupt(ADC10_VECTOR)))
+ * void ADC10_VECTOR_ISR(void)
+ * {
+ * 	ADC10_ISR();
+ * 	SCHED_WAKE_ON_EXIT();
+ * }
+ *
+ * PT_THREAD(Report(Sched_Task *task))
+ * {
+ *   static uint16_t raw;
+ *   static uint8_t i;
+ *
+ *   PT_BEGIN(&task->pt);
+ *   while (1) {
+ *     SCHED_DELAY(task, TIMERA0_MS(1000));
+ *     PT_WAIT_UNTIL(&task->pt, ADC10_AnalogPoll(0, &raw));
+ *     for (i = 0; i < 4; i++) {
+ *       PT_WAIT_UNTIL(&task->pt, UARTA0_TrySend("0123456789ABCDEF"[raw & 0xF]));
+ *       raw >>= 4;
+ *     }
+ *   }
+ *   PT_END(&task->pt);
+ * }
+ *
+ * Sched_Task report;
+ * Sched_Add(&report, Report);
+ * Sched_Run();
+ * ~~~
+ */
+
+#ifndef SCHED_H_
+#define SCHED_H_
+
+#include <msp430.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "PT.h"
+#include "drivers/TimerA0.h"
+
+#ifndef SCHED_MAX_TASKS
+#define SCHED_MAX_TASKS 4
+#endif
+
+/// Low power mode to sleep in when every task is waiting. The UART runs from
+/// SMCLK, so the default keeps SMCLK on.
+#ifndef SCHED_LPM_BITS
+#define SCHED_LPM_BITS  LPM0_bits
+#endif
+
+struct sched_task_t {
+  TimerA0_Timer timer;            // First, so the timer can find its task
+  PT pt;                          // Where the task is up to
+  uint8_t (*run)(struct sched_task_t *task);
+  volatile bool timeout;          // Set when the SCHED_DELAY timer runs out
+};
+
+typedef struct sched_task_t Sched_Task;
+
+/// Set by ISRs when they may have unblocked a task
+extern volatile bool Sched_pending;
+
+/// Tell the run loop to check the tasks again, and wake the CPU. ISRs only.
+#define SCHED_WAKE_ON_EXIT() do { \
+  Sched_pending = true; \
+  __bic_SR_register_on_exit(SCHED_LPM_BITS); } while (0)
+
+/// Wait for a number of TimerA0 ticks, e.g. TIMERA0_MS(10)
+#define SCHED_DELAY(task, ticks) do { \
+  Sched_Timeout(task, ticks); \
+  PT_WAIT_UNTIL(&(task)->pt, (task)->timeout); } while (0)
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Add a task to the run loop, starting from the beginning.
+ * A task is dropped from the run loop once it exits or ends.
+ * @param task The task record. Must stay in scope while the task runs.
+ * @param run The protothread to run.
+ * @returns False if SCHED_MAX_TASKS are already running.
+ */
+bool Sched_Add(Sched_Task *task, uint8_t (*run)(Sched_Task *task));
+
+/**
+ * Start the task's timer. task->timeout is set when it runs out, so a wait
+ * can also be given a time limit:
+ * ~~~{.c}
+ * Sched_Timeout(task, TIMERA0_MS(50));
+ * PT_WAIT_UNTIL(&task->pt, !UARTA0_Empty() || task->timeout);
+ * ~~~
+ * @param task The task.
+ * @param ticks TimerA0 ticks until the timeout.
+ */
+void Sched_Timeout(Sched_Task *task, uint32_t ticks);
+
+/**
+ * Run the tasks, forever.
+ * Tasks are called in turn for as long as any of them are making progress.
+ * Once they are all waiting, the CPU sleeps until an ISR uses
+ * SCHED_WAKE_ON_EXIT.
+ */
+void Sched_Run(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SCHED_H_ */
@@ -0,0 +1,151 @@
+/*
+ * @file TLV.c
+ * @brief Validated TLV calibration lookup for MSP430x2xx
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-04
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <msp430.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "TLV.h"
+
+/// First and one-past-last byte of the TLV segment
+#define TLV_START  TLV_CHECKSUM_
+#define TLV_END    (TLV_CHECKSUM_ + 0x40)
+
+// Not every device header defines these
+#ifndef TAG_DCO_30
+#define TAG_DCO_30   0x01
+#endif
+#ifndef TAG_ADC10_1
+#define TAG_ADC10_1  0x10
+#endif
+#ifndef TAG_EMPTY
+#define TAG_EMPTY    0xFE
+#endif
+
+/// Byte offsets in the DCO_30 record
+static const uint8_t TLV_dco_offset[TLV_DCO_COUNT] = {
+  CAL_DCO_1MHZ,
+  CAL_DCO_8MHZ,
+  CAL_DCO_12MHZ,
+  CAL_DCO_16MHZ,
+};
+
+/// Word offsets in the ADC10_1 record
+#define TLV_ADC_15T30  3
+#define TLV_ADC_15T85  4
+
+TLV_Cal TLV_cal;
+
+/**
+ * Check the TLV checksum.
+ * The checksum word holds the two's complement of the XOR of every other word
+ * in the segment, so adding it to that XOR gives zero.
+ */
+static bool TLV_Checksum(void)
+{
+  const uint16_t *word = (const uint16_t *)(TLV_START + 2);
+  uint16_t sum = 0;
+
+  while (word < (const uint16_t *)TLV_END)
+  {
+    sum ^= *word++;
+  }
+  return (uint16_t)(sum + *(const uint16_t *)TLV_START) == 0;
+}
+
+const uint8_t * TLV_Find(uint8_t tag, uint8_t *len)
+{
+  const uint8_t *p = (const uint8_t *)(TLV_START + 2);
+
+  // Each record is tag, length, then length bytes of data
+  while (p + 2 <= (const uint8_t *)TLV_END)
+  {
+    if (p[0] == tag)
+    {
+      if (p + 2 + p[1] > (const uint8_t *)TLV_END)
+      {
+        break;                        // Record runs off the end, so corrupt
+      }
+      if (len)
+      {
+        *len = p[1];
+      }
+      return p + 2;
+    }
+    if (p[0] == 0xFF)
+    {
+      break;                          // Erased flash, no more records
+    }
+    p += 2 + p[1];
+  }
+  return NULL;
+}
+
+bool TLV_Init(void)
+{
+  const uint8_t *data;
+  uint8_t len;
+  uint8_t i;
+
+  TLV_cal.flags = TLV_CHECKED;
+  if (!TLV_Checksum())
+  {
+    return false;
+  }
+  TLV_cal.flags |= TLV_VALID;
+
+  data = TLV_Find(TAG_DCO_30, &len);
+  if (data && (len >= 8))
+  {
+    for (i = 0; i < TLV_DCO_COUNT; i++)
+    {
+      TLV_cal.dco[i] = data[TLV_dco_offset[i]];
+      TLV_cal.bc1[i] = data[TLV_dco_offset[i] + 1];
+      // Frequencies that weren't calibrated are left erased
+      if ((TLV_cal.dco[i] != 0xFF) || (TLV_cal.bc1[i] != 0xFF))
+      {
+        TLV_cal.flags |= (TLV_HAS_DCO << i);
+      }
+    }
+  }
+
+  data = TLV_Find(TAG_ADC10_1, &len);
+  if (data && (len >= 2 * (TLV_ADC_15T85 + 1)))
+  {
+    const uint16_t *adc = (const uint16_t *)data;
+    TLV_cal.adc_15t30 = adc[TLV_ADC_15T30];
+    TLV_cal.adc_15t85 = adc[TLV_ADC_15T85];
+    if ((TLV_cal.adc_15t30 != 0xFFFF) && (TLV_cal.adc_15t85 > TLV_cal.adc_15t30))
+    {
+      TLV_cal.flags |= TLV_HAS_ADC;
+    }
+  }
+
+  return true;
+}
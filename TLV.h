@@ -0,0 +1,111 @@
+/*
+ * @file TLV.h
+ * @brief Validated TLV calibration lookup for MSP430x2xx
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-04
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @details
+ * The TLV segment (Info A, 0x10C0-0x10FF) starts with a checksum word,
+ * followed by tag/length/data records. TLV_Init checks the checksum once,
+ * walks the records looking for the DCO and ADC10 calibration tags, and copies
+ * what it finds into TLV_cal. Everything else (clock.h, ADC10.c) reads the
+ * cached copy instead of poking at fixed flash addresses.
+ */
+
+#ifndef TLV_H_
+#define TLV_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/// @name Calibrated DCO frequencies, used to index TLV_cal.dco and .bc1
+/// @{
+#define TLV_DCO_1MHZ   0
+#define TLV_DCO_8MHZ   1
+#define TLV_DCO_12MHZ  2
+#define TLV_DCO_16MHZ  3
+#define TLV_DCO_COUNT  4
+/// @}
+
+/// @name TLV_cal.flags bits
+/// @{
+#define TLV_CHECKED    0x01 ///< TLV_Init has run
+#define TLV_VALID      0x02 ///< Segment checksum matched
+#define TLV_HAS_ADC    0x04 ///< ADC10 temperature calibration found
+#define TLV_HAS_DCO    0x10 ///< DCO calibration found, shifted by TLV_DCO_*
+/// @}
+
+struct tlv_cal_t {
+	uint8_t dco[TLV_DCO_COUNT];   // DCOCTL values
+	uint8_t bc1[TLV_DCO_COUNT];   // BCSCTL1 values
+	uint16_t adc_15t30;           // ADC10 reading at 30C, 1.5V reference
+	uint16_t adc_15t85;           // ADC10 reading at 85C, 1.5V reference
+	uint8_t flags;                // TLV_* flags
+};
+
+typedef struct tlv_cal_t TLV_Cal;
+
+/// Cached calibration data, filled in by TLV_Init
+extern TLV_Cal TLV_cal;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Validate the TLV segment and cache the calibration data.
+ * Nothing is cached if the checksum doesn't match.
+ * @returns True if the segment checksum is valid.
+ */
+bool TLV_Init(void);
+
+/**
+ * Find a tag in the TLV segment.
+ * @param tag The tag to search for (TAG_DCO_30, TAG_ADC10_1, ...).
+ * @param len Set to the length of the tag's data, if not NULL.
+ * @returns Pointer to the tag's data, or NULL if it isn't there.
+ */
+const uint8_t * TLV_Find(uint8_t tag, uint8_t *len);
+
+/**
+ * Check if calibration data for a DCO frequency is available.
+ * Runs TLV_Init if it hasn't been run yet.
+ * @param freq One of TLV_DCO_1MHZ, TLV_DCO_8MHZ, etc.
+ */
+static inline bool TLV_HasDCO(uint8_t freq)
+{
+	if (!(TLV_cal.flags & TLV_CHECKED))
+	{
+		TLV_Init();
+	}
+	return TLV_cal.flags & (TLV_HAS_DCO << freq);
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* TLV_H_ */
@@ -33,11 +33,96 @@
 // Includes
 // ========
 #include <stdint.h>		// Standardizes sizes for variables
+#include <stdbool.h>
 #include "BCDConv.h"	// Binary to BCD Conversion functions
 #include "VT100.h"		// VT100 Terminal Library (which this file defines)
 
+#ifndef VT_OUT_BUFFER_SIZE
+#define VT_OUT_BUFFER_SIZE	32	///< Size of the buffered sink, in bytes
+#endif
+
 /** Address of the function for sending characters to terminal. */
-static void (*VT_Transmit)(char);
+static void (*VT_TXFunc)(char);
+
+/** Address of the bulk write function. Output is buffered when set. */
+static void (*VT_WriteFunc)(const char *, uint8_t);
+
+static char VT_out_buffer[VT_OUT_BUFFER_SIZE];	///< Buffered sink output
+static uint8_t VT_out_len;						///< Bytes in VT_out_buffer
+
+/** Screen model. Widgets draw into it instead of the terminal when set. */
+static struct {
+	vt_cell *cells;			// cols * rows cells, row by row
+	uint8_t cols;			// Width of the screen model
+	uint8_t rows;			// Height of the screen model
+	uint8_t attr;			// Attribute for newly drawn cells
+	uint8_t x;				// Column the next VT_Draw_Char goes to
+	uint8_t y;				// Row the next VT_Draw_Char goes to
+} VT_screen;
+
+// Output tracker parser states
+#define VT_TRACK_TEXT	0	///< Plain text
+#define VT_TRACK_ESC	1	///< Got ESC
+#define VT_TRACK_CSI	2	///< Got ESC [
+#define VT_TRACK_SKIP	3	///< Skip one byte (ESC ( and ESC ) take one)
+
+#define VT_TRACK_PARAMS	6	///< Most CSI parameters the tracker will keep
+
+// Output tracker SGR flags
+#define VT_SGR_BRIGHT	0x01	///< Bright (a.k.a. bold) is on
+#define VT_SGR_OTHER	0x02	///< Some other attribute (underscore, etc.) is on
+#define VT_SGR_VALID	0x80	///< The other flags are known
+
+#define VT_ATTR_UNKNOWN	0xFF	///< Terminal colors not known
+
+/**
+ * What the terminal is known to be doing, worked out from everything sent.
+ * Zero in any field means it isn't known.
+ */
+static struct {
+	uint8_t x;				// Cursor column
+	uint8_t y;				// Cursor row
+	uint8_t saved_x;		// Column stored by a save cursor
+	uint8_t saved_y;		// Row stored by a save cursor
+	uint8_t top;			// Top row of the scrolling region, 0 for default
+	uint8_t bottom;			// Bottom row of the scrolling region, 0 for default
+	char fg;				// Foreground color character, VT_BLK to VT_WHT
+	char bg;				// Background color character, VT_BLK to VT_WHT
+	uint8_t sgr;			// VT_SGR_* flags
+	uint8_t state;			// Escape sequence parser state
+	uint8_t nparam;			// Index of the CSI parameter being read
+	uint8_t param[VT_TRACK_PARAMS];	// CSI parameters
+} VT_term;
+
+/** VT_CAP_* flags for what the terminal supports beyond VT100. */
+static uint8_t VT_caps;
+
+/** Where to go back to after drawing a widget, 0 if unknown. */
+static uint8_t VT_return_x;
+static uint8_t VT_return_y;
+
+#ifdef VT_STATS
+/** Characters sent to the terminal since the last VT_Bytes_Reset. */
+static uint32_t VT_bytes;
+
+/**
+ * Get the number of characters sent to the terminal.
+ * Counts everything VT_Transmit sends, buffered or not, since start-up or the
+ * last VT_Bytes_Reset.
+ */
+uint32_t VT_Bytes(void)
+{
+	return VT_bytes;
+}
+
+/**
+ * Start counting characters sent to the terminal from zero.
+ */
+void VT_Bytes_Reset(void)
+{
+	VT_bytes = 0;
+}
+#endif
 
 /**
  * Sets the VT_Transmit function.
@@ -45,7 +130,286 @@ static void (*VT_Transmit)(char);
  */
 void VT_SetTXFunc(void (*TX_func)(char))
 {
-	VT_Transmit = TX_func;
+	VT_TXFunc = TX_func;
+}
+
+/**
+ * Tell the library about terminal features beyond VT100.
+ * By default only VT100 sequences are used.
+ * @param	caps	VT_CAP_* flags for the features the terminal supports.
+ */
+void VT_SetCaps(uint8_t caps)
+{
+	VT_caps = caps;
+}
+
+/**
+ * Sets the bulk write function and switches to buffered output.
+ * Everything sent to the terminal is collected in a buffer and handed over
+ * in one call when the buffer fills up or VT_Flush is called. Pass NULL to go
+ * back to sending one character at a time through the VT_SetTXFunc function.
+ * @param	*write_func	The function for writing a block of characters.
+ */
+void VT_SetWriteFunc(void (*write_func)(const char *, uint8_t))
+{
+	VT_Flush();
+	VT_WriteFunc = write_func;
+}
+
+/**
+ * Hand any buffered output to the bulk write function.
+ * Does nothing when output isn't buffered.
+ */
+void VT_Flush(void)
+{
+	if (VT_out_len)
+	{
+		VT_WriteFunc(VT_out_buffer, VT_out_len);
+		VT_out_len = 0;
+	}
+}
+
+/**
+ * Send a character through either the buffer or the per-character function.
+ * @param	c	The character to send.
+ */
+static inline void VT_Output(char c)
+{
+#ifdef VT_STATS
+	VT_bytes++;
+#endif
+	if (VT_WriteFunc)
+	{
+		VT_out_buffer[VT_out_len++] = c;
+		if (VT_out_len >= VT_OUT_BUFFER_SIZE)
+		{
+			VT_Flush();
+		}
+	} else {
+		VT_TXFunc(c);
+	}
+}
+
+/**
+ * Update the tracked colors for a finished SGR (ESC [ ... m) sequence.
+ * @param	count	Number of parameters received.
+ */
+static void VT_Track_SGR(uint8_t count)
+{
+	uint8_t i;
+	uint8_t p;
+
+	if (count > VT_TRACK_PARAMS)
+	{
+		VT_term.fg = 0;						// Lost some, so colors unknown
+		VT_term.bg = 0;
+		VT_term.sgr = 0;
+		return;
+	}
+	for (i = 0; i < count; i++)
+	{
+		p = VT_term.param[i];
+		if (p == 0)
+		{
+			VT_term.fg = 0;					// Terminal default, not known
+			VT_term.bg = 0;
+			VT_term.sgr = VT_SGR_VALID;
+		} else if (p == 1) {
+			VT_term.sgr |= VT_SGR_BRIGHT;
+		} else if ((p >= 30) && (p <= 37)) {
+			VT_term.fg = '0' + (p - 30);
+		} else if ((p >= 40) && (p <= 47)) {
+			VT_term.bg = '0' + (p - 40);
+		} else {
+			VT_term.sgr |= VT_SGR_OTHER;
+		}
+	}
+}
+
+/**
+ * Follow the effect of one character on the terminal's cursor and colors.
+ * Every character sent goes through here, so the cursor position is known
+ * after any VT_Pos, whether or not it was sent by this library.
+ * @param	c	The character being sent.
+ */
+static void VT_Track(char c)
+{
+	uint8_t n;
+	uint8_t top = VT_term.top ? VT_term.top : 1;
+	uint8_t bottom = VT_term.bottom ? VT_term.bottom : VT_ROWS;
+
+	switch (VT_term.state)
+	{
+		case VT_TRACK_TEXT:
+			if (c == '\x1B')
+			{
+				VT_term.state = VT_TRACK_ESC;
+			} else if (c == '\r') {
+				VT_term.x = 1;
+			} else if (c == '\n') {
+				// At the bottom margin the region scrolls instead
+				if (VT_term.y && (VT_term.y != bottom) && (VT_term.y < VT_ROWS))
+				{
+					VT_term.y++;
+				}
+			} else if (c == '\b') {
+				if (VT_term.x > 1)
+				{
+					VT_term.x--;
+				}
+			} else if (c == '\t') {
+				VT_term.x = 0;
+			} else if ((uint8_t)c >= ' ') {
+				if (VT_term.x)
+				{
+					VT_term.x++;
+					if (VT_term.x > VT_COLS)
+					{
+						VT_term.x = 0;			// Wrap pending, unknown
+					}
+				}
+			}
+			break;
+
+		case VT_TRACK_ESC:
+			VT_term.state = VT_TRACK_TEXT;
+			if (c == '[')
+			{
+				VT_term.state = VT_TRACK_CSI;
+				VT_term.nparam = 0;
+				for (n = 0; n < VT_TRACK_PARAMS; n++)
+				{
+					VT_term.param[n] = 0;
+				}
+			} else if (c == '7') {
+				VT_term.saved_x = VT_term.x;
+				VT_term.saved_y = VT_term.y;
+			} else if (c == '8') {
+				VT_term.x = VT_term.saved_x;
+				VT_term.y = VT_term.saved_y;
+			} else if ((c == '(') || (c == ')')) {
+				VT_term.state = VT_TRACK_SKIP;
+			} else {
+				VT_term.x = 0;
+				VT_term.y = 0;
+			}
+			break;
+
+		case VT_TRACK_SKIP:
+			VT_term.state = VT_TRACK_TEXT;
+			break;
+
+		case VT_TRACK_CSI:
+			if ((c >= '0') && (c <= '9'))
+			{
+				if (VT_term.nparam < VT_TRACK_PARAMS)
+				{
+					n = VT_term.param[VT_term.nparam];
+					// Saturate at 255 rather than wrap, so 256 and up stay off-screen
+					VT_term.param[VT_term.nparam] =
+						((n > 25) || ((n == 25) && (c > '5'))) ? 255 : (n * 10) + (c - '0');
+				}
+				break;
+			}
+			if (c == ';')
+			{
+				if (VT_term.nparam <= VT_TRACK_PARAMS)
+				{
+					VT_term.nparam++;
+				}
+				break;
+			}
+			if ((c < '@') || (c > '~'))
+			{
+				break;							// '?' and other intermediates
+			}
+
+			// Final character
+			VT_term.state = VT_TRACK_TEXT;
+			n = VT_term.param[0] ? VT_term.param[0] : 1;
+			switch (c)
+			{
+				case 'A':						// Stops at the top margin
+					if (VT_term.y)
+					{
+						top = (VT_term.y >= top) ? top : 1;
+						VT_term.y = (VT_term.y - top > n) ? (VT_term.y - n) : top;
+					}
+					break;
+				case 'B':						// Stops at the bottom margin
+					if (VT_term.y)
+					{
+						bottom = (VT_term.y <= bottom) ? bottom : VT_ROWS;
+						VT_term.y = (n < bottom - VT_term.y) ?
+							(VT_term.y + n) : bottom;
+					}
+					break;
+				case 'C':
+					if (VT_term.x)
+					{
+						VT_term.x = (n < VT_COLS - VT_term.x) ?
+							(VT_term.x + n) : VT_COLS;
+					}
+					break;
+				case 'D':
+					if (VT_term.x)
+					{
+						VT_term.x = (VT_term.x > n) ? (VT_term.x - n) : 1;
+					}
+					break;
+				case 'H':
+				case 'f':
+					VT_term.y = n;
+					VT_term.x = VT_term.param[1] ? VT_term.param[1] : 1;
+					if (VT_term.nparam >= VT_TRACK_PARAMS)
+					{
+						VT_term.x = 0;
+						VT_term.y = 0;
+					}
+					break;
+				case 's':
+					VT_term.saved_x = VT_term.x;
+					VT_term.saved_y = VT_term.y;
+					break;
+				case 'u':
+					VT_term.x = VT_term.saved_x;
+					VT_term.y = VT_term.saved_y;
+					break;
+				case 'r':
+					VT_term.top = VT_term.param[0];
+					VT_term.bottom = VT_term.param[1];
+					VT_term.x = 1;				// Setting margins homes cursor
+					VT_term.y = 1;
+					break;
+				case 'm':
+					VT_Track_SGR(VT_term.nparam + 1);
+					break;
+				case 'h':						// Modes, erasing, and reports
+				case 'l':						// don't move the cursor
+				case 'J':
+				case 'K':
+				case 'X':
+				case 'n':
+				case 'x':						// DECFRA
+				case 'z':						// DECERA
+					break;
+				default:
+					VT_term.x = 0;
+					VT_term.y = 0;
+					break;
+			}
+			break;
+	}
+}
+
+/**
+ * Send a character to terminal, keeping track of what it does.
+ * @param	c	The character to send.
+ */
+static void VT_Transmit(char c)
+{
+	VT_Track(c);
+	VT_Output(c);
 }
 
 /**
@@ -90,20 +454,61 @@ void VT_Print_Hex_Val(uint8_t hex)
 	VT_Transmit(Lookup_Hex_Low(hex));
 }
 
+/**
+ * Print a number in decimal, without leading zeros.
+ * @param	num		The number to print.
+ */
+static void VT_Print_Num(uint8_t num)
+{
+	uint16_t bcd = bin2bcd8(num);
+	if (bcd >= 0x100)
+	{
+		VT_Transmit('0' + (bcd >> 8));
+	}
+	if (bcd >= 0x10)
+	{
+		VT_Transmit(Lookup_Hex_Low(bcd >> 4));
+	}
+	VT_Transmit(Lookup_Hex_Low(bcd));
+}
+
+/**
+ * Number of characters needed to print a number in decimal.
+ * @param	num		The number to print.
+ */
+static uint8_t VT_Num_Cost(uint8_t num)
+{
+	return (num < 10) ? 1 : ((num < 100) ? 2 : 3);
+}
+
+/**
+ * Number of characters needed for a VT_Move.
+ * @param	num		Distance to move the cursor.
+ */
+static uint8_t VT_Move_Cost(uint8_t num)
+{
+	return 3 + ((num > 1) ? VT_Num_Cost(num) : 0);
+}
+
 /**
  * Move the cursor to a specific row and column in the terminal.
+ * Parameters that are 1 are left out, since that's the default.
  * @param	x	The column location to go to (generally 1-80).
  * @param	y	The row location to go to (generally 1-24).
  */
 void VT_Pos(uint8_t x, uint8_t y)
 {
-	x = bin2bcd8(x);
-	y = bin2bcd8(y);
 	VT_Transmit('\x1B');
 	VT_Transmit('[');
-	VT_Print_Hex_Val(y);
-	VT_Transmit(';');
-	VT_Print_Hex_Val(x);
+	if (y > 1)
+	{
+		VT_Print_Num(y);
+	}
+	if (x > 1)
+	{
+		VT_Transmit(';');
+		VT_Print_Num(x);
+	}
 	VT_Transmit('H');
 }
 
@@ -118,355 +523,1826 @@ void VT_Move(uint8_t num, char dir)
 	VT_Transmit('[');
 	if (num > 1)
 	{
-		num = bin2bcd8(num);
-		VT_Print_Hex_Val(num);
+		VT_Print_Num(num);
 	}
 	VT_Transmit(dir);
 }
 
 /**
- * Sets the Color of either the foreground or background.
- * @param	fg_bg	'3' to set foreground, '4' to set background.
- * @param	color	Character for the new color. See the VT color set.
+ * Set the scrolling region.
+ * Line feeds on the bottom row of the region scroll only the rows from top
+ * to bottom, across the full width of the terminal. The cursor goes to the
+ * home position.
+ * @param	top		The top row of the region, or 0 to reset to full screen.
+ * @param	bottom	The bottom row of the region.
  */
-void VT_ColorSet(char fg_bg, char color)
+void VT_Scroll_Region(uint8_t top, uint8_t bottom)
 {
 	VT_Transmit('\x1B');
 	VT_Transmit('[');
-	VT_Transmit(fg_bg);
-	VT_Transmit(color);
-	VT_Transmit('m');
+	if (top)
+	{
+		VT_Print_Num(top);
+		VT_Transmit(';');
+		VT_Print_Num(bottom);
+	}
+	VT_Transmit('r');
 }
 
 /**
- * Draws a box with the current position as the upper left corner.
- * @param	width	The width of the box in characters.
- * @param	height	The height of the box in characters.
+ * Get the terminal's current colors as screen model cell attributes.
+ * @return	The attributes, or VT_ATTR_UNKNOWN if they can't be expressed.
  */
-void VT_Draw_Box(uint8_t width, uint8_t height)
+static uint8_t VT_Term_Attr(void)
 {
-	uint8_t i;
-	height-=2;	// Subtract top and bottom borders
+	uint8_t attr;
 
-	VT_Save_Cur();
-	// Top border
-	for (i=width; i>0; i--)
-	{
-		VT_Transmit('=');
-	}
-	// Right border
-	VT_Move(1,VT_DN);
-	VT_Move(1,VT_LT);
-	for (i=height; i>0; i--)
-	{
-			VT_Transmit('|');
-			VT_Move(1,VT_DN);
-			VT_Move(1,VT_LT);
-	}
-	// Left border
-	VT_Unsave_Cur();
-	VT_Move(1,VT_DN);
-	for (i=height; i>0; i--)
+	if (!VT_term.fg || !VT_term.bg
+			|| ((VT_term.sgr & (VT_SGR_VALID | VT_SGR_OTHER)) != VT_SGR_VALID))
 	{
-		VT_Transmit('|');
-		VT_Move(1,VT_DN);
-		VT_Move(1,VT_LT);
+		return VT_ATTR_UNKNOWN;
 	}
-	// Bottom border
-	for (i=width; i>0; i--)
+	attr = VT_ATTR(VT_term.fg, VT_term.bg);
+	if (VT_term.sgr & VT_SGR_BRIGHT)
 	{
-			VT_Transmit('=');
+		attr |= VT_ATTR_BRIGHT;
 	}
-	VT_Unsave_Cur();
-
+	return attr;
 }
 
 /**
- * Prints out all character codes from 0x20 to 0xFF.
+ * Check if the screen model knows what's on part of a row, so the cursor can
+ * be moved right by sending those characters again.
+ * @param	x1	First column to send.
+ * @param	x2	Column after the last one to send.
+ * @param	y	The row.
+ * @return	True if every cell is in the model and uses the current colors.
  */
-void Show_Characters(void)
+static bool VT_Can_Overwrite(uint8_t x1, uint8_t x2, uint8_t y)
 {
-	VT_Print("All Available Characters\r\n");
-		int16_t i;
-		for (i=32; i<256; i++)
+	vt_cell *cell;
+	uint8_t attr = VT_Term_Attr();
+
+	if (!VT_screen.cells || (y > VT_screen.rows) || (x2 - 1 > VT_screen.cols)
+			|| (attr == VT_ATTR_UNKNOWN))
+	{
+		return false;
+	}
+	cell = &VT_screen.cells[(uint16_t)(y - 1) * VT_screen.cols + (x1 - 1)];
+	for (; x1 < x2; x1++, cell++)
+	{
+		if ((cell->attr & ~VT_ATTR_DIRTY) != attr)
 		{
-			if ((i & 0x0F) == 0)
-			{
-				VT_Print("\r\n");
-			}
-			VT_SendChar(i);
+			return false;
 		}
-		VT_Print("\r\n");
+	}
+	return true;
 }
 
 /**
- * Initializes a horizontal slider GUI item.
- * Value of slider stored in val->val2, and can be 0 to width-1.
- * @param	x		The column of the leftmost slider character.
- * @param	y		The row of the slider.
- * @param	width	The width of the slider, in characters.
- * @param	item	The gui_item object to hold the slider.
+ * Send screen model cells to move the cursor right over them.
+ * Dirty cells are brought up to date on the way.
+ * @param	x1	First column to send.
+ * @param	x2	Column after the last one to send.
+ * @param	y	The row.
  */
-void VT_HSlide_Init(uint8_t x, uint8_t y, uint8_t width, gui_item * val)
+static void VT_Overwrite(uint8_t x1, uint8_t x2, uint8_t y)
 {
-	val->x = x;					// Set x location (column)
-	val->y = y;					// Set y location (row)
-	val->val1 = width;				// Set val1 to width.
-	val->val2 = width >> 1;		// Start slider at midpoint.
-	VT_HSlide_Draw(val);			// Make the initial draw call.
+	vt_cell *cell;
+
+	cell = &VT_screen.cells[(uint16_t)(y - 1) * VT_screen.cols + (x1 - 1)];
+	for (; x1 < x2; x1++, cell++)
+	{
+		cell->attr &= ~VT_ATTR_DIRTY;
+		VT_Transmit(cell->ch);
+	}
 }
 
+// Ways of getting the cursor to the right column
+#define VT_GO_NONE		0	///< Already in the column
+#define VT_GO_MOVE		1	///< ESC [ n C or ESC [ n D
+#define VT_GO_OVER		2	///< Send the characters in between again
+#define VT_GO_BS		3	///< Backspaces
+#define VT_GO_CR		4	///< Carriage return
+#define VT_GO_CR_MOVE	5	///< Carriage return, then ESC [ n C
+#define VT_GO_CR_OVER	6	///< Carriage return, then send characters again
+
 /**
- * Handles any input to a horizontal slider.
- * Slider will react to A,B,C, and D. The arrow keys generate these through
- * their escape sequences (<esc>[A <esc>[B etc.)
- * @param	in		The character input to handle.
- * @param	values	The gui item values for the slider being handled.
+ * Move the cursor to a specific row and column with the fewest characters.
+ * If the cursor position is known, every way of getting there is costed:
+ * VT_Pos, VT_Move up/down/left/right, line feeds, backspaces, carriage
+ * return, and (when a screen model is attached and knows what's there)
+ * sending the characters in between again. The cheapest one is used.
+ * @param	x	The column location to go to.
+ * @param	y	The row location to go to.
  */
-int8_t VT_HSlide_Handle(uint8_t in, gui_item * values)
+void VT_Goto(uint8_t x, uint8_t y)
 {
-	uint8_t update = 0;
-	switch(in)
+	uint8_t cx = VT_term.x;
+	uint8_t cy = VT_term.y;
+	uint8_t best;
+	uint8_t vert = 0;
+	uint8_t horiz = 0;
+	uint8_t how = VT_GO_NONE;
+	uint8_t cost;
+	uint8_t n;
+
+	if ((cx == x) && (cy == y))
 	{
-		// Left Arrow: decrease slider
-		case 'D':
-			if (values->val2 > 0)
+		return;
+	}
+
+	// Relative moves and line feeds stop at the scrolling region margins
+	if (VT_term.top || VT_term.bottom)
+	{
+		n = VT_term.bottom ? VT_term.bottom : VT_ROWS;
+		if (((cy <= n) && (y > n)) || ((cy >= VT_term.top) && (y < VT_term.top)))
+		{
+			cy = 0;
+		}
+	}
+
+	// Absolute position: ESC [ y ; x H, with 1s left out
+	best = 3 + ((y > 1) ? VT_Num_Cost(y) : 0) + ((x > 1) ? 1 + VT_Num_Cost(x) : 0);
+
+	if (cx && cy)
+	{
+		// Vertical: line feeds or ESC [ n B down, ESC [ n A up
+		if (y > cy)
+		{
+			n = y - cy;
+			vert = VT_Move_Cost(n);
+			if (n <= vert)
 			{
-				values->val2--;
-				update = 1;
+				vert = n;
 			}
-			break;
-		// Right Arrow: increase slider
-		case 'C':
-			if (values->val2 < (values->val1-1))
+		} else if (y < cy) {
+			vert = VT_Move_Cost(cy - y);
+		}
+
+		// Horizontal
+		if (x > cx)
+		{
+			n = x - cx;
+			horiz = VT_Move_Cost(n);
+			how = VT_GO_MOVE;
+			if ((n < horiz) && VT_Can_Overwrite(cx, x, y))
 			{
-				values->val2++;
-				update = 1;
+				horiz = n;
+				how = VT_GO_OVER;
 			}
-			break;
-		// Up Arrow: return -1 to go to previous GUI item
-		case 'A':
-			return -1;
-		// Down Arrow: return 1 to go to next GUI item
-		case 'B':
-			return 1;
+		} else if (x < cx) {
+			n = cx - x;
+			horiz = VT_Move_Cost(n);
+			how = VT_GO_MOVE;
+			if (n < horiz)
+			{
+				horiz = n;
+				how = VT_GO_BS;
+			}
+			if (x == 1)
+			{
+				cost = 1;
+				n = VT_GO_CR;
+			} else {
+				cost = 1 + VT_Move_Cost(x - 1);
+				n = VT_GO_CR_MOVE;
+				if ((x < cost) && VT_Can_Overwrite(1, x, y))
+				{
+					cost = x;
+					n = VT_GO_CR_OVER;
+				}
+			}
+			if (cost < horiz)
+			{
+				horiz = cost;
+				how = n;
+			}
+		}
 	}
-	// Redraw slider only if value changed.
-	if (update)
+
+	if (!(cx && cy) || (vert + horiz >= best))
 	{
-		VT_HSlide_Draw(values);
+		VT_Pos(x, y);
+		return;
 	}
-	return 0;
-}
-
-/**
- * Draws a horizontal slider.
- * @param	values	The gui item values to use in drawing.
- */
-void VT_HSlide_Draw(gui_item * values)
-{
-	uint8_t i;								// Temporary count variable
 
-	VT_Hide_Cur();							// Hide cursor to avoid flicker
-	VT_Pos(values->x,values->y);			// Position to x,y for GUI item
-	for(i=values->val1; i>0; i--)			// Loop to place down slider bar
+	if (y > cy)
 	{
-		VT_Transmit('-');
+		n = y - cy;
+		if (vert == n)
+		{
+			for (; n > 0; n--)
+			{
+				VT_Transmit('\n');
+			}
+		} else {
+			VT_Move(n, VT_DN);
+		}
+	} else if (y < cy) {
+		VT_Move(cy - y, VT_UP);
 	}
-	VT_ColorSet(VT_FG,VT_STD_HL);			// Use highlight color for slider
-											// position
-	VT_Move((values->val1 - values->val2),VT_LT);
-	VT_Transmit('|');
-	VT_ColorSet(VT_FG,VT_STD_FG);			// Return to standard color
-	VT_Move(1,VT_LT);						// Move cursor onto slider position
-	VT_Show_Cur();							// Show cursor again
+
+	switch (how)
+	{
+		case VT_GO_MOVE:
+			if (x > cx)
+			{
+				VT_Move(x - cx, VT_RT);
+			} else {
+				VT_Move(cx - x, VT_LT);
+			}
+			break;
+		case VT_GO_OVER:
+			VT_Overwrite(cx, x, y);
+			break;
+		case VT_GO_BS:
+			for (n = cx - x; n > 0; n--)
+			{
+				VT_Transmit('\b');
+			}
+			break;
+		case VT_GO_CR:
+			VT_Transmit('\r');
+			break;
+		case VT_GO_CR_MOVE:
+			VT_Transmit('\r');
+			VT_Move(x - 1, VT_RT);
+			break;
+		case VT_GO_CR_OVER:
+			VT_Transmit('\r');
+			VT_Overwrite(1, x, y);
+			break;
+	}
+}
+
+/**
+ * Sets the Color of either the foreground or background.
+ * @param	fg_bg	'3' to set foreground, '4' to set background.
+ * @param	color	Character for the new color. See the VT color set.
+ */
+void VT_ColorSet(char fg_bg, char color)
+{
+	if (color == ((fg_bg == VT_FG) ? VT_term.fg : VT_term.bg))
+	{
+		return;								// Already set
+	}
+	VT_Transmit('\x1B');
+	VT_Transmit('[');
+	VT_Transmit(fg_bg);
+	VT_Transmit(color);
+	VT_Transmit('m');
+}
+
+/**
+ * Start the next parameter of a merged SGR sequence.
+ * @param	count	Parameters sent so far, incremented.
+ */
+static void VT_SGR_Next(uint8_t *count)
+{
+	if (*count)
+	{
+		VT_Transmit(';');
+	} else {
+		VT_Transmit('\x1B');
+		VT_Transmit('[');
+	}
+	(*count)++;
+}
+
+/**
+ * Set the colors and brightness in one go.
+ * Only what differs from the terminal's current state is sent, merged into a
+ * single ESC [ a;b;c m sequence. Nothing is sent if nothing changes. Since
+ * VT100 has no "bright off", turning bright off costs a reset, after which
+ * both colors are sent again.
+ * @param	attr	Attributes, as for the screen model. Use VT_ATTR() and
+ * 					VT_ATTR_BRIGHT.
+ */
+void VT_SetAttr(uint8_t attr)
+{
+	char fg = '0' + (attr & 0x07);
+	char bg = '0' + ((attr >> 3) & 0x07);
+	char cur_fg = VT_term.fg;
+	char cur_bg = VT_term.bg;
+	uint8_t sgr = VT_term.sgr;
+	uint8_t count = 0;
+
+	if (((sgr & (VT_SGR_VALID | VT_SGR_OTHER)) != VT_SGR_VALID)
+			|| ((sgr & VT_SGR_BRIGHT) && !(attr & VT_ATTR_BRIGHT)))
+	{
+		VT_SGR_Next(&count);
+		VT_Transmit(VT_RESET);
+		cur_fg = 0;
+		cur_bg = 0;
+		sgr = 0;
+	}
+	if ((attr & VT_ATTR_BRIGHT) && !(sgr & VT_SGR_BRIGHT))
+	{
+		VT_SGR_Next(&count);
+		VT_Transmit(VT_BRIGHT);
+	}
+	if (fg != cur_fg)
+	{
+		VT_SGR_Next(&count);
+		VT_Transmit(VT_FG);
+		VT_Transmit(fg);
+	}
+	if (bg != cur_bg)
+	{
+		VT_SGR_Next(&count);
+		VT_Transmit(VT_BG);
+		VT_Transmit(bg);
+	}
+	if (count)
+	{
+		VT_Transmit('m');
+	}
+}
+
+/**
+ * Start drawing a widget.
+ * In the terminal, the cursor is hidden to avoid flicker, and its position is
+ * remembered if the widget needs to put it back afterwards.
+ * @param	keep	True to remember the cursor position for VT_Draw_End.
+ */
+static void VT_Draw_Begin(uint8_t keep)
+{
+	if (VT_screen.cells)
+	{
+		return;
+	}
+	if (keep)
+	{
+		VT_return_x = VT_term.x;
+		VT_return_y = VT_term.y;
+		if (!(VT_return_x && VT_return_y))
+		{
+			VT_return_x = 0;
+			VT_Save_Cur();					// Save to return to proper spot
+		}
+	}
+	VT_Hide_Cur();							// Hide cursor to avoid flicker
+}
+
+/**
+ * Finish drawing a widget.
+ * In the terminal, the cursor is moved and shown again.
+ * @param	x	Column to leave the cursor in, 0 to go back to where it was.
+ * @param	y	Row to leave the cursor in.
+ */
+static void VT_Draw_End(uint8_t x, uint8_t y)
+{
+	if (VT_screen.cells)
+	{
+		return;
+	}
+	if (x)
+	{
+		VT_Goto(x, y);
+	} else if (VT_return_x) {
+		VT_Goto(VT_return_x, VT_return_y);
+	} else {
+		VT_Unsave_Cur();					// Return cursor to original pos
+	}
+	VT_Show_Cur();							// Show cursor again
+}
+
+/**
+ * Set where the next VT_Draw_Char goes.
+ * @param	x	The column.
+ * @param	y	The row.
+ */
+static void VT_Draw_At(uint8_t x, uint8_t y)
+{
+	if (VT_screen.cells)
+	{
+		VT_screen.x = x;
+		VT_screen.y = y;
+	} else {
+		VT_Goto(x, y);
+	}
+}
+
+/**
+ * Draw a character into the screen model or terminal, then move right.
+ * @param	c	The character to draw.
+ */
+static void VT_Draw_Char(char c)
+{
+	if (VT_screen.cells)
+	{
+		VT_Screen_Put(VT_screen.x++, VT_screen.y, c);
+	} else {
+		VT_Transmit(c);
+	}
+}
+
+/**
+ * Switch between the standard and highlight colors for drawing.
+ * @param	on	True for highlight, false for standard.
+ */
+static void VT_Draw_HL(uint8_t on)
+{
+	if (VT_screen.cells)
+	{
+		VT_Screen_SetAttr(on ? VT_ATTR_HL : VT_ATTR_STD);
+	} else {
+		VT_ColorSet(VT_FG, on ? VT_STD_HL : VT_STD_FG);
+	}
+}
+
+/**
+ * Fill a rectangle with one character, into the screen model if one is
+ * attached. The cursor is moved, and colors are left as they are.
+ * Spaces are sent as erases where the terminal can do it in fewer bytes:
+ * one DECERA for the whole rectangle (VT_CAP_RECT), otherwise per row an
+ * erase to end of line if the row reaches the right edge, or an erase
+ * characters (VT_CAP_ECH). Other characters use one DECFRA when available.
+ * @param	x	The column of the left edge.
+ * @param	y	The row of the top edge.
+ * @param	w	Width of the rectangle.
+ * @param	h	Height of the rectangle.
+ * @param	c	The character to fill with.
+ */
+void VT_Fill(uint8_t x, uint8_t y, uint8_t w, uint8_t h, char c)
+{
+	uint8_t i;
+	uint8_t j;
+
+	if (!w || !h)
+	{
+		return;
+	}
+	if (VT_screen.cells)
+	{
+		VT_Screen_Fill(x, y, w, h, c);
+		return;
+	}
+
+	// DECERA: ESC [ top ; left ; bottom ; right $ z
+	// DECFRA: ESC [ char ; top ; left ; bottom ; right $ x
+	if (VT_caps & VT_CAP_RECT)
+	{
+		VT_Transmit('\x1B');
+		VT_Transmit('[');
+		if (c != ' ')
+		{
+			VT_Print_Num((uint8_t)c);
+			VT_Transmit(';');
+		}
+		VT_Print_Num(y);
+		VT_Transmit(';');
+		VT_Print_Num(x);
+		VT_Transmit(';');
+		VT_Print_Num(y + h - 1);
+		VT_Transmit(';');
+		VT_Print_Num(x + w - 1);
+		VT_Transmit('$');
+		VT_Transmit((c != ' ') ? 'x' : 'z');
+		return;
+	}
+
+	for (j = y; j < y + h; j++)
+	{
+		VT_Goto(x, j);
+		if ((c == ' ') && (x + w > VT_COLS))
+		{
+			VT_Print("\x1B[K");				// Erase to end of line
+		} else if ((c == ' ') && (VT_caps & VT_CAP_ECH)
+				&& (VT_Move_Cost(w) < w)) {
+			VT_Move(w, 'X');				// Erase characters
+		} else {
+			for (i = w; i > 0; i--)
+			{
+				VT_Transmit(c);
+			}
+		}
+	}
+}
+
+/**
+ * Draws the border of a box, and optionally clears the inside.
+ * @param	x		The column of the upper left corner.
+ * @param	y		The row of the upper left corner.
+ * @param	width	The width of the box in characters, at least 2.
+ * @param	height	The height of the box in characters, at least 2.
+ * @param	clear	Nonzero to clear the inside of the box.
+ */
+static void VT_Box_Draw(uint8_t x, uint8_t y, uint8_t width, uint8_t height,
+		uint8_t clear)
+{
+	uint8_t i;
+	uint8_t right = x + width - 1;
+	uint8_t bottom = y + height - 1;
+
+	// Top border
+	VT_Draw_At(x, y);
+	for (i=width; i>0; i--)
+	{
+		VT_Draw_Char('=');
+	}
+	// Clear the inside in one go if the terminal can
+	if (clear && (VT_caps & VT_CAP_RECT) && (height > 2))
+	{
+		VT_Fill(x + 1, y + 1, width - 2, height - 2, ' ');
+	}
+	// Left and right borders, a row at a time
+	for (i=y+1; i<bottom; i++)
+	{
+		VT_Draw_At(x, i);
+		VT_Draw_Char('|');
+		if (clear && !(VT_caps & VT_CAP_RECT))
+		{
+			VT_Fill(x + 1, i, width - 2, 1, ' ');
+		}
+		VT_Draw_At(right, i);
+		VT_Draw_Char('|');
+	}
+	// Bottom border
+	VT_Draw_At(x, bottom);
+	for (i=width; i>0; i--)
+	{
+		VT_Draw_Char('=');
+	}
+}
+
+/**
+ * Draws a box at a given position, into the screen model if one is attached.
+ * The inside of the box is cleared. Boxes narrower or shorter than 2
+ * characters are not drawn.
+ * @param	x		The column of the upper left corner.
+ * @param	y		The row of the upper left corner.
+ * @param	width	The width of the box in characters.
+ * @param	height	The height of the box in characters.
+ */
+void VT_Box(uint8_t x, uint8_t y, uint8_t width, uint8_t height)
+{
+	if ((width < 2) || (height < 2))
+	{
+		return;
+	}
+	VT_Box_Draw(x, y, width, height, 1);
+}
+
+/**
+ * Draws a box with the current position as the upper left corner.
+ * Only the border is drawn, the inside is left as it is. Boxes narrower or
+ * shorter than 2 characters are not drawn. With a screen model attached the
+ * border goes into the model, from the cursor if its position is known and
+ * otherwise from where the model was last drawn to.
+ * @param	width	The width of the box in characters.
+ * @param	height	The height of the box in characters.
+ */
+void VT_Draw_Box(uint8_t width, uint8_t height)
+{
+	uint8_t i;
+	uint8_t x = VT_term.x;
+	uint8_t y = VT_term.y;
+
+	if ((width < 2) || (height < 2))
+	{
+		return;
+	}
+	// The model must see the border, so VT_Refresh keeps the screen right
+	if (VT_screen.cells)
+	{
+		if (!x || !y)
+		{
+			x = VT_screen.x ? VT_screen.x : 1;
+			y = VT_screen.y ? VT_screen.y : 1;
+		}
+		VT_Box_Draw(x, y, width, height, 0);
+		VT_screen.x = x;
+		VT_screen.y = y;
+		return;
+	}
+	// Draw from known corner when possible, so moves can be optimized
+	if (x && y)
+	{
+		VT_Box_Draw(x, y, width, height, 0);
+		VT_Goto(x, y);
+		return;
+	}
+
+	height-=2;	// Subtract top and bottom borders
+
+	VT_Save_Cur();
+	// Top border
+	for (i=width; i>0; i--)
+	{
+		VT_Transmit('=');
+	}
+	// Right border
+	VT_Move(1,VT_DN);
+	VT_Move(1,VT_LT);
+	for (i=height; i>0; i--)
+	{
+			VT_Transmit('|');
+			VT_Move(1,VT_DN);
+			VT_Move(1,VT_LT);
+	}
+	// Left border
+	VT_Unsave_Cur();
+	VT_Move(1,VT_DN);
+	for (i=height; i>0; i--)
+	{
+		VT_Transmit('|');
+		VT_Move(1,VT_DN);
+		VT_Move(1,VT_LT);
+	}
+	// Bottom border
+	for (i=width; i>0; i--)
+	{
+			VT_Transmit('=');
+	}
+	VT_Unsave_Cur();
+
+}
+
+/**
+ * Prints out all character codes from 0x20 to 0xFF.
+ */
+void Show_Characters(void)
+{
+	VT_Print("All Available Characters\r\n");
+		int16_t i;
+		for (i=32; i<256; i++)
+		{
+			if ((i & 0x0F) == 0)
+			{
+				VT_Print("\r\n");
+			}
+			VT_SendChar(i);
+		}
+		VT_Print("\r\n");
+}
+
+/**
+ * Draw a run of one character going right.
+ * @param	x		The column of the first character.
+ * @param	y		The row.
+ * @param	count	Number of characters to draw.
+ * @param	c		The character to draw.
+ * @param	hl		True to draw in the highlight color.
+ */
+static void VT_Draw_Run(uint8_t x, uint8_t y, uint8_t count, char c, uint8_t hl)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	VT_Draw_At(x, y);
+	VT_Draw_HL(hl);
+	for (; count > 0; count--)
+	{
+		VT_Draw_Char(c);
+	}
+}
+
+/**
+ * Initializes a horizontal slider GUI item.
+ * Value of slider stored in val->val2, and can be 0 to width-1.
+ * @param	x		The column of the leftmost slider character.
+ * @param	y		The row of the slider.
+ * @param	width	The width of the slider, in characters.
+ * @param	item	The gui_item object to hold the slider.
+ */
+void VT_HSlide_Init(uint8_t x, uint8_t y, uint8_t width, gui_item * val)
+{
+	val->x = x;					// Set x location (column)
+	val->y = y;					// Set y location (row)
+	val->val1 = width;				// Set val1 to width.
+	val->val2 = width >> 1;		// Start slider at midpoint.
+	val->prev = VT_ITEM_REDRAW;	// Nothing drawn yet
+	VT_HSlide_Draw(val);			// Make the initial draw call.
+}
+
+/**
+ * Handles any input to a horizontal slider.
+ * Slider will react to the arrow keys, as decoded by VT_Key_Decode.
+ * @param	in		The key to handle.
+ * @param	values	The gui item values for the slider being handled.
+ */
+int8_t VT_HSlide_Handle(uint8_t in, gui_item * values)
+{
+	uint8_t update = 0;
+	switch(in)
+	{
+		// Left Arrow: decrease slider
+		case VT_KEY_LEFT:
+			if (values->val2 > 0)
+			{
+				values->val2--;
+				update = 1;
+			}
+			break;
+		// Right Arrow: increase slider
+		case VT_KEY_RIGHT:
+			if (values->val2 < (values->val1-1))
+			{
+				values->val2++;
+				update = 1;
+			}
+			break;
+		// Up Arrow: return -1 to go to previous GUI item
+		case VT_KEY_UP:
+			return -1;
+		// Down Arrow: return 1 to go to next GUI item
+		case VT_KEY_DOWN:
+			return 1;
+	}
+	// Redraw slider only if value changed.
+	if (update)
+	{
+		VT_HSlide_Draw(values);
+	}
+	return 0;
+}
+
+/**
+ * Draws a horizontal slider.
+ * Only the old and new knob cells are drawn, unless values->prev is
+ * VT_ITEM_REDRAW. The cursor is left on the knob.
+ * @param	values	The gui item values to use in drawing.
+ */
+void VT_HSlide_Draw(gui_item * values)
+{
+	uint8_t x = values->x;
+	uint8_t y = values->y;
+	uint8_t old = values->prev - 1;			// Knob position last drawn
+
+	if ((values->prev != VT_ITEM_REDRAW) && (old == values->val2))
+	{
+		return;								// Nothing changed
+	}
+	VT_Draw_Begin(0);
+	if (values->prev == VT_ITEM_REDRAW)
+	{
+		VT_Draw_Run(x, y, values->val1, '-', 0);	// Whole slider bar
+	} else {
+		VT_Draw_Run(x + old, y, 1, '-', 0);	// Erase old knob
+	}
+	VT_Draw_Run(x + values->val2, y, 1, '|', 1);	// Highlighted knob
+	VT_Draw_HL(0);							// Return to standard color
+	values->prev = values->val2 + 1;
+	VT_Draw_End(x + values->val2, y);		// Cursor onto slider position
+}
+
+/**
+ * Initializes a vertical slider GUI item.
+ * Value of slider stored in val->val2, and can be 0 to height-1.
+ * @param	x		The column of the slider.
+ * @param	y		The row of the topmost character of the slider.
+ * @param	height	The height of the slider, in characters.
+ * @param	item	The gui_item object to hold the slider.
+ */
+void VT_VSlide_Init(uint8_t x, uint8_t y, uint8_t height, gui_item * val)
+{
+	val->x = x;					// Set x location (column)
+	val->y = y;					// Set y location (row)
+	val->val1 = height;			// Set val1 to height.
+	val->val2 = height >> 1;		// Start slider at midpoint.
+	val->prev = VT_ITEM_REDRAW;	// Nothing drawn yet
+	VT_VSlide_Draw(val);			// Make the initial draw call.
+}
+
+/**
+ * Handles any input to a vertical slider.
+ * Slider will react to the arrow keys, as decoded by VT_Key_Decode.
+ * @param	in		The key to handle.
+ * @param	values	The gui item values for the slider being handled.
+ */
+int8_t VT_VSlide_Handle(uint8_t in, gui_item * values)
+{
+	uint8_t update = 0;
+	switch(in)
+	{
+		// Down Arrow: decrease slider value
+		case VT_KEY_DOWN:
+			if (values->val2 > 0)
+			{
+				values->val2--;
+				update = 1;
+			}
+			break;
+		// Up Arrow: increase slider value
+		case VT_KEY_UP:
+			if (values->val2 < (values->val1-1))
+			{
+				values->val2++;
+				update = 1;
+			}
+			break;
+		// Left Arrow: return -1 to go to previous GUI item
+		case VT_KEY_LEFT:
+			return -1;
+		// Right Arrow: return 1 to go to next GUI item
+		case VT_KEY_RIGHT:
+			return 1;
+	}
+	// Redraw only if value changed
+	if (update)
+	{
+		VT_VSlide_Draw(values);
+	}
+	return 0;
+}
+
+/**
+ * Draws a vertical slider.
+ * Only the old and new knob cells are drawn, unless values->prev is
+ * VT_ITEM_REDRAW. The cursor is left on the knob.
+ * @param	values	The gui item values to use in drawing.
+ */
+void VT_VSlide_Draw(gui_item * values)
+{
+	uint8_t i;								// Temporary count variable
+	uint8_t x = values->x;
+	uint8_t bottom = values->y + values->val1 - 1;
+	uint8_t old = values->prev - 1;			// Knob position last drawn
+
+	if ((values->prev != VT_ITEM_REDRAW) && (old == values->val2))
+	{
+		return;								// Nothing changed
+	}
+	VT_Draw_Begin(0);
+	if (values->prev == VT_ITEM_REDRAW)
+	{
+		for(i=values->y; i<=bottom; i++)	// Loop to place down slider bar
+		{
+			VT_Draw_Run(x, i, 1, '|', 0);
+		}
+	} else {
+		VT_Draw_Run(x, bottom - old, 1, '|', 0);	// Erase old knob
+	}
+	VT_Draw_Run(x, bottom - values->val2, 1, '=', 1);	// Highlighted knob
+	VT_Draw_HL(0);							// Return to standard color
+	values->prev = values->val2 + 1;
+	VT_Draw_End(x, bottom - values->val2);	// Cursor onto slider position
+}
+
+/**
+ * Initializes a horizontal bar GUI item.
+ * Length of bar stored in val->val2, and can be 0 to width.
+ * @param	x		The column of the leftmost bar character.
+ * @param	y		The row of the bar.
+ * @param	width	The width of the bar, in characters.
+ * @param	item	The gui_item object to hold the bar.
+ */
+void VT_HBar_Init(uint8_t x, uint8_t y, uint8_t width, gui_item * val)
+{
+	val->x = x;					// Set x location (column)
+	val->y = y;					// Set y location (row)
+	val->val1 = width;				// Set val1 to width.
+	val->val2 = width >> 1;		// Start bar at midpoint.
+	val->prev = VT_ITEM_REDRAW;	// Nothing drawn yet
+	VT_HBar_Draw(val);			// Make the initial draw call.
+}
+
+/**
+ * Draws a horizontal bar.
+ * The first val2 cells are filled in with the highlight color. Only the cells
+ * between the old and new length are drawn, unless values->prev is
+ * VT_ITEM_REDRAW. The cursor is left at the end of the bar.
+ * @param	values	The gui item values to use in drawing.
+ */
+void VT_HBar_Draw(gui_item * values)
+{
+	uint8_t x = values->x;
+	uint8_t y = values->y;
+	uint8_t len = values->val2;
+	uint8_t prev = values->prev - 1;		// Length last drawn
+
+	if ((values->prev != VT_ITEM_REDRAW) && (prev == len))
+	{
+		return;								// Nothing changed
+	}
+	VT_Draw_Begin(0);
+	if (values->prev == VT_ITEM_REDRAW)
+	{
+		VT_Draw_Run(x, y, len, '=', 1);
+		VT_Draw_Run(x + len, y, values->val1 - len, '-', 0);
+	} else if (len > prev) {
+		VT_Draw_Run(x + prev, y, len - prev, '=', 1);	// Grow
+	} else {
+		VT_Draw_Run(x + len, y, prev - len, '-', 0);	// Shrink
+	}
+	VT_Draw_HL(0);							// Return to standard color
+	values->prev = len + 1;
+	VT_Draw_End(x + ((len < values->val1) ? len : values->val1 - 1), y);
+}
+
+/**
+ * Set up parameters for a scatter plot.
+ * @param	x	x (column) location for upper left corner of plot area.
+ * @param	y	y (row) location for upper left corner of plot area.
+ * @param	w	Width of the plot area.
+ * @param	h	Height of the plot area.
+ * @param	val	The GUI item values for the plot being set up.
+ */
+void VT_Scatter_Init(uint8_t x, uint8_t y, uint8_t w, uint8_t h, gui_item * val)
+{
+	val->x = x;
+	val->y = y;
+	val->val1 = w;
+	val->val2 = h;
+	VT_Draw_Begin(0);
+	VT_Box(x-1, y-1, w+2, h+2);
+	VT_Draw_End(x-1, y-1);
+}
+
+/**
+ * Make a mark on the scatter plot.
+ * The coordinate system is like a screen: x is increasing from left to right,
+ * and y is increasing from top to bottom.
+ * @param	x	The x location for the mark within the plot.
+ * @param	y	The y location for the mark within the plot.
+ * @param	val	The GUI item values for the plot being drawn on.
+ */
+void VT_Scatter_Update(uint8_t x, uint8_t y, gui_item * val)
+{
+	VT_Draw_Begin(1);
+	VT_Draw_At(val->x + x, val->y + y);		// Set to x,y within graph
+	VT_Draw_HL(1);							// Use highlight color for mark
+	VT_Draw_Char('X');
+	VT_Draw_HL(0);							// Return to standard color
+	VT_Draw_End(0, 0);
+}
+
+/**
+ * Clear a scatter plot of marks.
+ * @param	val	The GUI item values of the plot being cleared.
+ */
+void VT_Scatter_Clear(gui_item * val)
+{
+	VT_Draw_Begin(1);
+	VT_Draw_HL(0);							// Erase in standard colors
+	VT_Fill(val->x, val->y, val->val1, val->val2, ' ');
+	VT_Draw_End(0, 0);
+}
+
+/**
+ * Initializes a strip chart GUI item.
+ * Each sample is shown as a mark in its own row, with the newest at the
+ * bottom, and is the column of the mark counting from x. The last height
+ * samples are kept in a ring the caller supplies, so the chart is repainted
+ * with its history after the screen was cleared. Nothing is drawn outside
+ * the width by height box. Charts with no width or taller than the terminal
+ * are rejected, leaving an item that draws nothing. The chart starts out
+ * empty on its first draw.
+ * @param	x		x (column) location for upper left corner of the chart.
+ * @param	y		y (row) location for upper left corner of the chart.
+ * @param	width	Width of the chart in columns. Samples past it are clipped.
+ * @param	height	Height of the chart, which is the number of samples shown.
+ * @param	samples	Buffer of height bytes for the ring of samples.
+ * @param	val		The GUI item values for the chart being set up.
+ */
+void VT_Chart_Init(uint8_t x, uint8_t y, uint8_t width, uint8_t height,
+		uint8_t * samples, gui_item * val)
+{
+	uint8_t i;
+
+	if ((width == 0) || (height > VT_ROWS) || (x > VT_COLS))
+	{
+		height = 0;							// Nothing to draw into
+	} else if (width > VT_COLS - x + 1) {
+		width = VT_COLS - x + 1;			// Stop at the right edge
+	}
+	val->x = x;
+	val->y = y;
+	val->val1 = height;
+	val->val2 = 0;
+	val->val3 = width;
+	val->val16 = 0;						// Ring index of the oldest sample
+	val->data = samples;
+	for (i = 0; i < height; i++)
+	{
+		samples[i] = 0;						// Empty row
+	}
+	val->prev = VT_ITEM_REDRAW;	// Nothing drawn yet
+}
+
+/**
+ * Add a sample to a strip chart without drawing it.
+ * The ring holds each sample plus 1, with 0 for a row with no sample yet.
+ * val->prev counts the samples not drawn yet, plus 1, so VT_Chart_Draw can
+ * catch up on several at once. In a panel, add samples with this and set
+ * VT_WIDGET_DIRTY in the widget's flags, since VT_Panel_Set doesn't add one.
+ * @param	val		The GUI item values for the chart.
+ * @param	value	The sample. Marks past the chart width are clipped.
+ */
+void VT_Chart_Push(gui_item * val, uint8_t value)
+{
+	uint8_t height = val->val1;
+
+	if (height == 0)
+	{
+		return;
+	}
+	if (value >= val->val3)
+	{
+		value = val->val3 - 1;				// Clip to the chart width
+	}
+	val->val2 = value;
+	val->data[val->val16] = value + 1;
+	if (++val->val16 >= height)
+	{
+		val->val16 = 0;
+	}
+	if (val->prev != VT_ITEM_REDRAW)
+	{
+		if (val->prev > height)
+		{
+			val->prev = VT_ITEM_REDRAW;		// Every row has changed anyway
+		} else {
+			val->prev++;
+		}
+	}
+}
+
+/**
+ * Add a sample to a strip chart and draw it.
+ * @param	val		The GUI item values for the chart.
+ * @param	value	The sample. Marks past the chart width are clipped.
+ */
+void VT_Chart_Add(gui_item * val, uint8_t value)
+{
+	VT_Chart_Push(val, value);
+	VT_Chart_Draw(val);
+}
+
+/**
+ * Get the sample a strip chart row shows, from the ring.
+ * @param	val		The GUI item values for the chart.
+ * @param	row		Row counting from the top of the chart.
+ * @param	back	Number of samples back, 0 for what the row shows now.
+ * @return	The sample plus 1, or 0 for no sample.
+ */
+static uint8_t VT_Chart_Row(gui_item * val, uint8_t row, uint8_t back)
+{
+	uint8_t i = val->val16 + row + val->val1 - back;
+
+	while (i >= val->val1)
+	{
+		i -= val->val1;
+	}
+	return val->data[i];
+}
+
+/**
+ * Draw the samples added to a strip chart since it was last drawn.
+ * When the chart covers whole terminal rows, the rows are scrolled up with a
+ * scrolling region, so only the new marks are sent. Otherwise a scrolling
+ * region would move whatever is beside the chart, so each mark that moved is
+ * erased and drawn again in the row's new column, which is also how the
+ * screen model is drawn. Rows whose old sample has left the ring are cleared.
+ * If val->prev is VT_ITEM_REDRAW, the chart is repainted from the ring.
+ * @param	val		The GUI item values for the chart.
+ */
+void VT_Chart_Draw(gui_item * val)
+{
+	uint8_t x = val->x;
+	uint8_t height = val->val1;
+	uint8_t bottom = val->y + height - 1;
+	uint8_t redraw = (val->prev == VT_ITEM_REDRAW);
+	uint8_t pending = val->prev - 1;
+	uint8_t row;
+	uint8_t old;
+	uint8_t mark;
+
+	if ((height == 0) || (!redraw && (pending == 0)))
+	{
+		return;								// Bad size, or nothing new
+	}
+
+	VT_Draw_Begin(1);
+	if (!redraw && !VT_screen.cells && (x == 1) && (val->val3 == VT_COLS))
+	{
+		// Oldest new sample first, each scrolling the rows up one
+		VT_Scroll_Region(val->y, bottom);
+		for (row = height - pending; row < height; row++)
+		{
+			VT_Goto(x + VT_Chart_Row(val, row, 0) - 1, bottom);
+			VT_Transmit('\n');				// Scroll the chart up a row
+			VT_Draw_HL(1);					// Use highlight color for mark
+			VT_Draw_Char('*');
+		}
+		VT_Scroll_Region(0, 0);
+	} else {
+		// Erase in standard colors, then mark in highlight, so the colors
+		// only change once
+		VT_Draw_HL(0);
+		if (redraw)
+		{
+			VT_Fill(x, val->y, val->val3, height, ' ');
+		}
+		for (row = 0; !redraw && (row < height); row++)
+		{
+			if (row < pending)
+			{
+				VT_Fill(x, val->y + row, val->val3, 1, ' ');
+				continue;
+			}
+			old = VT_Chart_Row(val, row, pending);
+			if (old && (old != VT_Chart_Row(val, row, 0)))
+			{
+				VT_Draw_At(x + old - 1, val->y + row);
+				VT_Draw_Char(' ');
+			}
+		}
+		VT_Draw_HL(1);
+		for (row = 0; row < height; row++)
+		{
+			mark = VT_Chart_Row(val, row, 0);
+			old = (redraw || (row < pending)) ? 0
+					: VT_Chart_Row(val, row, pending);
+			if (mark && (mark != old))
+			{
+				VT_Draw_At(x + mark - 1, val->y + row);
+				VT_Draw_Char('*');
+			}
+		}
+	}
+	VT_Draw_HL(0);							// Return to standard color
+	VT_Draw_End(0, 0);
+	val->prev = 1;
+}
+
+/**
+ * Initializes a number readout GUI item.
+ * The readout shows val->val16 right-aligned, with leading zeros blanked. It
+ * is drawn in full the first time, then only the digits that change are sent.
+ * Widths outside 1 to 5 are rejected, leaving an item that draws nothing.
+ * @param	x		The column of the leftmost digit.
+ * @param	y		The row of the readout.
+ * @param	digits	Width of the readout, 1 to 5 digits.
+ * @param	val		The GUI item values for the readout being set up.
+ */
+void VT_Number_Init(uint8_t x, uint8_t y, uint8_t digits, gui_item * val)
+{
+	if ((digits == 0) || (digits > VT_NUMBER_DIGITS))
+	{
+		digits = 0;							// Too wide for VT_Number_Draw
+	}
+	val->x = x;
+	val->y = y;
+	val->val1 = digits;
+	val->val16 = 0;
+	val->prev16 = 0;
+	val->prev = VT_ITEM_REDRAW;	// Nothing drawn yet
+}
+
+/**
+ * Change the value of a number readout and draw it.
+ * @param	val		The GUI item values for the readout.
+ * @param	value	The new value.
+ */
+void VT_Number_Set(gui_item * val, uint16_t value)
+{
+	val->val16 = value;
+	VT_Number_Draw(val);
+}
+
+/**
+ * Get the character for one digit of a readout.
+ * @param	bcd		Packed BCD value, shifted so the digit is in the low nibble.
+ * @param	lead	True while only leading zeros have been seen, updated.
+ * @param	last	True for the ones digit, which is never blanked.
+ * @return	The digit, or a space for a leading zero.
+ */
+static char VT_Number_Char(uint32_t bcd, uint8_t *lead, uint8_t last)
+{
+	uint8_t digit = bcd & 0x0F;
+
+	if (digit || last)
+	{
+		*lead = 0;
+	}
+	return *lead ? ' ' : '0' + digit;
+}
+
+/**
+ * Get the packed BCD a readout shows for a value.
+ * Values up to 9999 take the 4-digit bin2bcd16, and only wider ones the
+ * 5-digit bin2bcd16l.
+ * @param	value	The value.
+ * @param	digits	Width of the readout.
+ * @return	Packed BCD of the value, or all 9s if it is too wide.
+ */
+static uint32_t VT_Number_BCD(uint16_t value, uint8_t digits)
+{
+	uint32_t bcd = (value > 9999) ? bin2bcd16l(value) : bin2bcd16(value);
+
+	if ((digits < VT_NUMBER_DIGITS) && (bcd >> (digits * 4)))
+	{
+		bcd = 0x99999;						// Too wide, show all 9s
+	}
+	return bcd;
 }
 
 /**
- * Initializes a vertical slider GUI item.
- * Value of slider stored in val->val2, and can be 0 to height-1.
- * @param	x		The column of the slider.
- * @param	y		The row of the topmost character of the slider.
- * @param	height	The height of the slider, in characters.
- * @param	item	The gui_item object to hold the slider.
+ * Draw a number readout.
+ * The value in val->val16 and the one last drawn (val->prev16) are converted
+ * to packed BCD and compared a nibble at a time. Only the span from the first
+ * to the last digit that changed is sent, so a slowly changing value usually
+ * costs a cursor move and one digit. Values too wide for the readout show as
+ * all 9s. The cursor is left after the last digit sent.
+ * @param	val		The GUI item values for the readout.
  */
-void VT_VSlide_Init(uint8_t x, uint8_t y, uint8_t height, gui_item * val)
+void VT_Number_Draw(gui_item * val)
 {
-	val->x = x;					// Set x location (column)
-	val->y = y;					// Set y location (row)
-	val->val1 = height;			// Set val1 to height.
-	val->val2 = height >> 1;		// Start slider at midpoint.
-	VT_VSlide_Draw(val);			// Make the initial draw call.
+	uint8_t digits = val->val1;
+	uint8_t redraw = (val->prev == VT_ITEM_REDRAW);
+	uint32_t bcd;
+	uint32_t shown;
+	uint8_t lead_new = 1;
+	uint8_t lead_old = 1;
+	uint8_t first = 0;
+	uint8_t last = 0;
+	uint8_t i;
+	char c;
+	char line[VT_NUMBER_DIGITS];
+
+	if ((digits == 0) || (digits > VT_NUMBER_DIGITS)
+			|| (!redraw && (val->prev16 == val->val16)))
+	{
+		return;								// Bad width, or nothing changed
+	}
+	bcd = VT_Number_BCD(val->val16, digits);
+	shown = VT_Number_BCD(val->prev16, digits);
+
+	// Work out the characters, and which ones changed
+	for (i = 0; i < digits; i++)
+	{
+		c = VT_Number_Char(bcd >> ((digits - 1 - i) * 4), &lead_new,
+				i == digits - 1);
+		line[i] = c;
+		if (redraw || (c != VT_Number_Char(
+				shown >> ((digits - 1 - i) * 4), &lead_old, i == digits - 1)))
+		{
+			if (!last)
+			{
+				first = i + 1;
+			}
+			last = i + 1;
+		}
+	}
+	val->prev16 = val->val16;
+	val->prev = 1;
+	if (!last)
+	{
+		return;								// Same digits on screen
+	}
+
+	VT_Draw_HL(0);
+	VT_Draw_At(val->x + first - 1, val->y);
+	for (i = first - 1; i < last; i++)
+	{
+		VT_Draw_Char(line[i]);
+	}
 }
 
 /**
- * Handles any input to a vertical slider.
- * Slider will react to A,B,C, and D. The arrow keys generate these through
- * their escape sequences (<esc>[A <esc>[B etc.)
- * @param	in		The character input to handle.
- * @param	values	The gui item values for the slider being handled.
+ * Attach a screen model.
+ * The model covers columns 1 to cols and rows 1 to rows of the terminal.
+ * While attached, the widget functions draw into the model instead of sending
+ * anything, and VT_Refresh sends only the cells that changed. Each cell is 2
+ * bytes, so an 80x24 screen needs 3840 bytes of RAM; on small parts use a
+ * smaller model covering just the dashboard area.
+ * All cells start out blank and dirty, so the first VT_Refresh paints the
+ * whole model.
+ * @param	cells	Buffer of cols * rows cells, or NULL to detach the model.
+ * @param	cols	Width of the screen model.
+ * @param	rows	Height of the screen model.
  */
-int8_t VT_VSlide_Handle(uint8_t in, gui_item * values)
+void VT_Screen_Init(vt_cell * cells, uint8_t cols, uint8_t rows)
 {
-	uint8_t update = 0;
-	switch(in)
+	uint16_t i;
+
+	VT_screen.cells = cells;
+	VT_screen.cols = cols;
+	VT_screen.rows = rows;
+	VT_screen.attr = VT_ATTR_STD;
+	if (cells)
 	{
-		// Down Arrow: decrease slider value
-		case 'B':
-			if (values->val2 > 0)
+		for (i = (uint16_t)cols * rows; i > 0; i--)
+		{
+			cells->ch = ' ';
+			cells->attr = VT_ATTR_STD | VT_ATTR_DIRTY;
+			cells++;
+		}
+	}
+}
+
+/**
+ * Mark every cell as dirty, so the next VT_Refresh repaints everything.
+ * Use after the terminal was cleared or reconnected.
+ */
+void VT_Screen_Invalidate(void)
+{
+	vt_cell *cell = VT_screen.cells;
+	uint16_t i;
+
+	for (i = (uint16_t)VT_screen.cols * VT_screen.rows; i > 0; i--)
+	{
+		(cell++)->attr |= VT_ATTR_DIRTY;
+	}
+}
+
+/**
+ * Set the attributes used for cells drawn from now on.
+ * @param	attr	Cell attributes. Use VT_ATTR() and VT_ATTR_BRIGHT.
+ */
+void VT_Screen_SetAttr(uint8_t attr)
+{
+	VT_screen.attr = attr & ~VT_ATTR_DIRTY;
+}
+
+/**
+ * Put a character in the screen model.
+ * The cell is only marked dirty if it actually changed. Positions outside the
+ * model are ignored.
+ * @param	x	The column (1 to cols).
+ * @param	y	The row (1 to rows).
+ * @param	c	The character to put.
+ */
+void VT_Screen_Put(uint8_t x, uint8_t y, char c)
+{
+	vt_cell *cell;
+
+	if ((x < 1) || (x > VT_screen.cols) || (y < 1) || (y > VT_screen.rows))
+	{
+		return;
+	}
+	cell = &VT_screen.cells[(uint16_t)(y - 1) * VT_screen.cols + (x - 1)];
+	if ((cell->ch != c) || ((cell->attr & ~VT_ATTR_DIRTY) != VT_screen.attr))
+	{
+		cell->ch = c;
+		cell->attr = VT_screen.attr | VT_ATTR_DIRTY;
+	}
+}
+
+/**
+ * Print a string into the screen model, going right from x,y.
+ * @param	x		The column of the first character.
+ * @param	y		The row.
+ * @param	string	The string to print.
+ */
+void VT_Screen_Print(uint8_t x, uint8_t y, char *string)
+{
+	while (*string)
+	{
+		VT_Screen_Put(x++, y, *string++);
+	}
+}
+
+/**
+ * Fill a rectangle of the screen model with one character.
+ * @param	x	The column of the left edge.
+ * @param	y	The row of the top edge.
+ * @param	w	Width of the rectangle.
+ * @param	h	Height of the rectangle.
+ * @param	c	The character to fill with.
+ */
+void VT_Screen_Fill(uint8_t x, uint8_t y, uint8_t w, uint8_t h, char c)
+{
+	uint8_t i;
+	uint8_t j;
+
+	for (j = 0; j < h; j++)
+	{
+		for (i = 0; i < w; i++)
+		{
+			VT_Screen_Put(x + i, y + j, c);
+		}
+	}
+}
+
+
+/**
+ * Send every changed cell of the screen model to the terminal.
+ * Cells are sent row by row, using VT_Goto to get to each one, so short gaps
+ * of unchanged cells are resent instead of jumped over when that's fewer
+ * bytes. Attributes are only sent when they differ from what the terminal is
+ * using. The standard colors are restored at the end.
+ */
+void VT_Refresh(void)
+{
+	vt_cell *row;
+	vt_cell *cell;
+	uint8_t x;
+	uint8_t y;
+	uint8_t sent = 0;
+
+	for (y = 0, row = VT_screen.cells; y < VT_screen.rows;
+			y++, row += VT_screen.cols)
+	{
+		for (x = 0; x < VT_screen.cols; x++)
+		{
+			cell = &row[x];
+			if (!(cell->attr & VT_ATTR_DIRTY))
 			{
-				values->val2--;
-				update = 1;
+				continue;
 			}
-			break;
-		// Up Arrow: increase slider value
-		case 'A':
-			if (values->val2 < (values->val1-1))
+			if (!sent)
 			{
-				values->val2++;
-				update = 1;
+				VT_Hide_Cur();				// Hide cursor to avoid flicker
+				sent = 1;
 			}
-			break;
-		// Left Arrow: return -1 to go to previous GUI item
-		case 'D':
-			return -1;
-		// Right Arrow: return 1 to go to next GUI item
-		case 'C':
-			return 1;
+			VT_Goto(x + 1, y + 1);
+			cell->attr &= ~VT_ATTR_DIRTY;
+			VT_SetAttr(cell->attr);
+			VT_Transmit(cell->ch);
+		}
 	}
-	// Redraw only if value changed
-	if (update)
+
+	if (sent)
 	{
-		VT_VSlide_Draw(values);
+		VT_SetAttr(VT_ATTR_STD);
+		VT_Show_Cur();						// Show cursor again
 	}
-	return 0;
 }
 
+// Key decoder states
+#define VT_KEY_S_TEXT	0	///< Plain text
+#define VT_KEY_S_CR		1	///< Got CR, swallow a following LF
+#define VT_KEY_S_ESC	2	///< Got ESC
+#define VT_KEY_S_CSI	3	///< Got ESC [
+#define VT_KEY_S_SS3	4	///< Got ESC O
+#define VT_KEY_S_MOD	5	///< Got ESC [ n ; (modifiers are ignored)
+
 /**
- * Draws a vertical slider.
- * @param	values	The gui item values to use in drawing.
+ * Key codes for ESC [ n ~, from n = 1 to 24. Zero for unused numbers.
  */
-void VT_VSlide_Draw(gui_item * values)
+static const uint8_t VT_key_tilde[24] = {
+	VT_KEY_HOME, VT_KEY_INS, VT_KEY_DEL, VT_KEY_END,		// 1-4
+	VT_KEY_PGUP, VT_KEY_PGDN, VT_KEY_HOME, VT_KEY_END,		// 5-8
+	0, 0, VT_KEY_F(1), VT_KEY_F(2),							// 9-12
+	VT_KEY_F(3), VT_KEY_F(4), VT_KEY_F(5), 0,				// 13-16
+	VT_KEY_F(6), VT_KEY_F(7), VT_KEY_F(8), VT_KEY_F(9),		// 17-20
+	VT_KEY_F(10), 0, VT_KEY_F(11), VT_KEY_F(12)				// 21-24
+};
+
+/**
+ * Reset a key decoder.
+ * @param	keys	The key decoder.
+ */
+void VT_Key_Init(VT_Keys * keys)
 {
-	uint8_t i;								// Temporary count variable
+	keys->state = VT_KEY_S_TEXT;
+	keys->param = 0;
+	keys->idle = 0;
+}
 
-	VT_Hide_Cur();							// Hide cursor to avoid flicker
-	VT_Pos(values->x,values->y);			// Position to x,y for GUI item
-	for(i=values->val1; i>0; i--)			// Loop to place down slider bar
+/**
+ * Look up the key for the final character of ESC [ or ESC O.
+ * @param	c	The final character.
+ * @return	The key code, or VT_KEY_NONE if unknown.
+ */
+static uint8_t VT_Key_Final(uint8_t c)
+{
+	switch (c)
 	{
-		VT_Transmit('|');
-		VT_Move(1,VT_DN);
-		VT_Move(1,VT_LT);
+		case 'A':	return VT_KEY_UP;
+		case 'B':	return VT_KEY_DOWN;
+		case 'C':	return VT_KEY_RIGHT;
+		case 'D':	return VT_KEY_LEFT;
+		case 'H':	return VT_KEY_HOME;
+		case 'F':	return VT_KEY_END;
+		case 'P':	return VT_KEY_F(1);
+		case 'Q':	return VT_KEY_F(2);
+		case 'R':	return VT_KEY_F(3);
+		case 'S':	return VT_KEY_F(4);
 	}
-	VT_ColorSet(VT_FG,VT_STD_HL);			// Use highlight color for slider
-											// position
-	VT_Move((values->val2+1),VT_UP);
-	VT_Transmit('=');
-	VT_ColorSet(VT_FG,VT_STD_FG);			// Return to standard color
-	VT_Move(1,VT_LT);						// Move cursor onto slider position
-	VT_Show_Cur();							// Show cursor again
+	return VT_KEY_NONE;
+}
+
+/**
+ * Feed one received byte into a key decoder.
+ * Escape sequences from the arrow, editing, and function keys are turned
+ * into single VT_KEY_* codes, in both normal (ESC [) and application (ESC O)
+ * cursor key modes. CR, LF, and CR LF all give VT_KEY_ENTER, and both BS and
+ * DEL give VT_KEY_BS. Other 7-bit bytes are returned unchanged. Bytes from
+ * 0x80 up are dropped, since they would clash with the VT_KEY_* codes, and
+ * so are unknown escape sequences.
+ *
+ * This is short and doesn't block, so it can be called straight from the RX
+ * interrupt. A lone ESC can't be told apart from the start of a sequence
+ * until more time has passed, so VT_Key_Tick must also be called regularly
+ * (from the same context) to get the Escape key.
+ * @param	keys	The key decoder.
+ * @param	c		The received byte.
+ * @return	The decoded key, or VT_KEY_NONE if nothing is complete yet.
+ */
+uint8_t VT_Key_Decode(VT_Keys * keys, uint8_t c)
+{
+	uint8_t state = keys->state;
+
+	keys->idle = 0;
+	keys->state = VT_KEY_S_TEXT;
+	switch (state)
+	{
+		case VT_KEY_S_CR:
+			if (c == '\n')
+			{
+				return VT_KEY_NONE;			// Second half of CR LF
+			}
+			// Fall through
+		case VT_KEY_S_TEXT:
+			switch (c)
+			{
+				case '\x1B':
+					keys->state = VT_KEY_S_ESC;
+					return VT_KEY_NONE;
+				case '\r':
+					keys->state = VT_KEY_S_CR;
+					return VT_KEY_ENTER;
+				case '\n':
+					return VT_KEY_ENTER;
+				case '\b':
+				case '\x7F':
+					return VT_KEY_BS;
+			}
+			if (c & 0x80)
+			{
+				return VT_KEY_NONE;			// 8-bit byte, looks like a key code
+			}
+			return c;
+
+		case VT_KEY_S_ESC:
+			if (c == '[')
+			{
+				keys->state = VT_KEY_S_CSI;
+				keys->param = 0;
+				return VT_KEY_NONE;
+			}
+			if (c == 'O')
+			{
+				keys->state = VT_KEY_S_SS3;
+				return VT_KEY_NONE;
+			}
+			if (c == '\x1B')
+			{
+				keys->state = VT_KEY_S_ESC;	// Escape key, then a new ESC
+				return VT_KEY_ESC;
+			}
+			if (c & 0x80)
+			{
+				return VT_KEY_NONE;			// 8-bit byte, looks like a key code
+			}
+			return c;						// Alt + key, drop the ESC
+
+		case VT_KEY_S_SS3:
+			return VT_Key_Final(c);
 
+		case VT_KEY_S_CSI:
+		case VT_KEY_S_MOD:
+			if ((c >= '0') && (c <= '9'))
+			{
+				if ((state == VT_KEY_S_CSI) && (keys->param < 25))
+				{
+					keys->param = (keys->param * 10) + (c - '0');
+				}
+				keys->state = state;
+				return VT_KEY_NONE;
+			}
+			if (c == ';')
+			{
+				keys->state = VT_KEY_S_MOD;
+				return VT_KEY_NONE;
+			}
+			if (c == '~')
+			{
+				if ((keys->param >= 1) && (keys->param <= 24))
+				{
+					return VT_key_tilde[keys->param - 1];
+				}
+				return VT_KEY_NONE;
+			}
+			if ((c < '@') || (c > '~'))
+			{
+				keys->state = state;		// Intermediate byte, keep going
+				return VT_KEY_NONE;
+			}
+			return VT_Key_Final(c);
+	}
+	return VT_KEY_NONE;
 }
 
 /**
- * Initializes a horizontal bar GUI item.
- * Value of bar stored in val->val2, and can be 0 to width-1.
- * @param	x		The column of the leftmost bar character.
- * @param	y		The row of the bar.
- * @param	width	The width of the bar, in characters.
- * @param	item	The gui_item object to hold the bar.
+ * Time out a key decoder that is waiting in the middle of a sequence.
+ * Call this at a steady rate, from the same context as VT_Key_Decode. After
+ * VT_KEY_TIMEOUT calls with no input, a lone ESC is returned as the Escape
+ * key and a partial sequence is dropped. The time per tick should be longer
+ * than a few characters at the baud rate in use.
+ * @param	keys	The key decoder.
+ * @return	VT_KEY_ESC on a timed out lone ESC, otherwise VT_KEY_NONE.
  */
-void VT_HBar_Init(uint8_t x, uint8_t y, uint8_t width, gui_item * val)
+uint8_t VT_Key_Tick(VT_Keys * keys)
 {
-	val->x = x;					// Set x location (column)
-	val->y = y;					// Set y location (row)
-	val->val1 = width;				// Set val1 to width.
-	val->val2 = width >> 1;		// Start bar at midpoint.
-	VT_HBar_Draw(val);			// Make the initial draw call.
+	if ((keys->state == VT_KEY_S_TEXT) || (keys->state == VT_KEY_S_CR))
+	{
+		return VT_KEY_NONE;
+	}
+	if (++keys->idle < VT_KEY_TIMEOUT)
+	{
+		return VT_KEY_NONE;
+	}
+	keys->idle = 0;
+	if (keys->state == VT_KEY_S_ESC)
+	{
+		keys->state = VT_KEY_S_TEXT;
+		return VT_KEY_ESC;
+	}
+	keys->state = VT_KEY_S_TEXT;
+	return VT_KEY_NONE;
 }
 
 /**
- * Draws a horizontal slider.
- * @param	values	The gui item values to use in drawing.
+ * Set up a panel of widgets.
+ * The widgets must already have their gui_item, handle, and draw fields set,
+ * normally through the matching Init function. Every widget is marked for a
+ * full redraw, and focus goes to the first one with a key handler.
+ * @param	panel		The panel.
+ * @param	widgets		Array of widgets in focus order.
+ * @param	count		Number of widgets.
+ * @param	interval	Minimum number of VT_Panel_Tick calls between renders.
  */
-void VT_HBar_Draw(gui_item * values)
+void VT_Panel_Init(VT_Panel * panel, vt_widget * widgets, uint8_t count,
+		uint8_t interval)
 {
-	uint8_t i;								// Temporary count variable
+	uint8_t i;
 
-	VT_Hide_Cur();							// Hide cursor to avoid flicker
-	VT_Pos(values->x,values->y);			// Position to x,y for GUI item
-	for(i=values->val1; i>0; i--)			// Loop to place down slider bar
+	panel->widgets = widgets;
+	panel->count = count;
+	panel->interval = interval;
+	panel->ticks = interval;				// First render can go right away
+	panel->focus = 0;
+	panel->pending = 0;
+	for (i = count; i > 0; i--)
 	{
-		VT_Transmit('-');
+		if (widgets[i - 1].handle)
+		{
+			panel->focus = i - 1;
+		}
 	}
-	VT_ColorSet(VT_FG,VT_STD_HL);			// Use highlight color for slider
-											// position
-	VT_Move((values->val1 - values->val2),VT_LT);
-	VT_Transmit('|');
-	VT_ColorSet(VT_FG,VT_STD_FG);			// Return to standard color
-	VT_Move(1,VT_LT);						// Move cursor onto slider position
-	VT_Show_Cur();							// Show cursor again
+	VT_Panel_Invalidate(panel);
 }
 
 /**
- * Set up parameters for a scatter plot.
- * @param	x	x (column) location for upper left corner of plot area.
- * @param	y	y (row) location for upper left corner of plot area.
- * @param	w	Width of the plot area.
- * @param	h	Height of the plot area.
- * @param	val	The GUI item values for the plot being set up.
+ * Mark every widget in a panel for a full redraw.
+ * Use after the terminal was cleared or reconnected.
+ * @param	panel	The panel.
  */
-void VT_Scatter_Init(uint8_t x, uint8_t y, uint8_t w, uint8_t h, gui_item * val)
+void VT_Panel_Invalidate(VT_Panel * panel)
 {
-	val->x = x;
-	val->y = y;
-	val->val1 = w;
-	val->val2 = h;
-	VT_Pos(x-1,y-1);
-	VT_Draw_Box(w+2,h+2);
+	vt_widget *w = panel->widgets;
+	uint8_t i;
+
+	for (i = panel->count; i > 0; i--, w++)
+	{
+		w->item.prev = VT_ITEM_REDRAW;
+		w->flags |= VT_WIDGET_DIRTY;
+	}
 }
 
 /**
- * Make a mark on the scatter plot.
- * The coordinate system is like a screen: x is increasing from left to right,
- * and y is increasing from top to bottom.
- * @param	x	The x location for the mark within the plot.
- * @param	y	The y location for the mark within the plot.
- * @param	val	The GUI item values for the plot being drawn on.
+ * Change the value (val2) of a widget.
+ * Nothing is sent now. The widget is drawn on the next render, so a value
+ * that changes faster than the frame rate only costs output for the last
+ * value of each frame.
+ * @param	panel	The panel.
+ * @param	index	Index of the widget.
+ * @param	value	The new value.
  */
-void VT_Scatter_Update(uint8_t x, uint8_t y, gui_item * val)
+void VT_Panel_Set(VT_Panel * panel, uint8_t index, uint8_t value)
 {
-	VT_Save_Cur();							// Save to return to proper spot
-	VT_Hide_Cur();							// Hide cursor to avoid flicker
+	vt_widget *w = &panel->widgets[index];
 
-	VT_Pos(val->x + x, val->y + y);			// Set to x,y within graph
-	VT_ColorSet(VT_FG,VT_STD_HL);			// Use highlight color for mark
-	VT_Transmit('X');
-	VT_ColorSet(VT_FG,VT_STD_FG);			// Return to standard color
+	if (w->item.val2 != value)
+	{
+		w->item.val2 = value;
+		w->flags |= VT_WIDGET_DIRTY;
+	}
+}
 
-	VT_Unsave_Cur();						// Return cursor to original pos
-	VT_Show_Cur();							// Show cursor again
+/**
+ * Change the 16-bit value (val16) of a widget, such as a number readout.
+ * Works like VT_Panel_Set.
+ * @param	panel	The panel.
+ * @param	index	Index of the widget.
+ * @param	value	The new value.
+ */
+void VT_Panel_Set16(VT_Panel * panel, uint8_t index, uint16_t value)
+{
+	vt_widget *w = &panel->widgets[index];
+
+	if (w->item.val16 != value)
+	{
+		w->item.val16 = value;
+		w->flags |= VT_WIDGET_DIRTY;
+	}
 }
 
 /**
- * Clear a scatter plot of marks.
- * @param	val	The GUI item values of the plot being cleared.
+ * Give a key to the focused widget.
+ * The widget's handler draws the change right away, since key input is
+ * limited by the user anyway. With a screen model or buffered output, that
+ * only reaches the terminal on the next VT_Panel_Render, even if no widget is
+ * dirty, so keep calling it. When the handler asks for the previous or next
+ * item, focus moves to the previous or next widget with a key handler,
+ * wrapping around at the ends.
+ * @param	panel	The panel.
+ * @param	key		The key, from VT_Key_Decode.
  */
-void VT_Scatter_Clear(gui_item * val)
+void VT_Panel_Key(VT_Panel * panel, uint8_t key)
 {
-	VT_Save_Cur();							// Save to return to proper spot
-	VT_Hide_Cur();							// Hide cursor to avoid flicker
+	vt_widget *w;
+	int8_t dir;
 	uint8_t i;
-	uint8_t j;
-	for (i=0; i < val->val2; i++)			// Loop for clearing by rows
+
+	if (!panel->count || !panel->widgets[panel->focus].handle)
+	{
+		return;
+	}
+	w = &panel->widgets[panel->focus];
+	dir = w->handle(key, &w->item);
+	panel->pending = 1;
+	if (dir == 0)
 	{
-		VT_Pos(val->x, val->y + i);
-		for (j=0; j < val->val1; j++)		// Loop for clearing a row out
+		return;
+	}
+
+	i = panel->focus;
+	do {
+		if (dir > 0)
 		{
-			VT_Transmit(' ');
+			i = (i + 1 < panel->count) ? i + 1 : 0;
+		} else {
+			i = i ? i - 1 : panel->count - 1;
 		}
+	} while (!panel->widgets[i].handle);
+	panel->focus = i;
+
+	// Show where the focus went
+	if (!VT_screen.cells)
+	{
+		w = &panel->widgets[i];
+		VT_Goto(w->item.x, w->item.y);
 	}
+}
 
-	VT_Unsave_Cur();						// Return cursor to original pos
-	VT_Show_Cur();							// Show cursor again
+/**
+ * Count time for a panel's frame rate limit.
+ * Call at a steady rate, for example from a timer interrupt.
+ * @param	panel	The panel.
+ */
+void VT_Panel_Tick(VT_Panel * panel)
+{
+	if (panel->ticks < panel->interval)
+	{
+		panel->ticks++;
+	}
+}
+
+/**
+ * Draw the widgets of a panel that changed.
+ * Does nothing until interval ticks have passed since the last render. Only
+ * widgets marked dirty are drawn. If anything was drawn here or by a key
+ * handler since the last render, VT_Refresh is called afterwards when a
+ * screen model is attached, and buffered output is flushed either way.
+ * @param	panel	The panel.
+ * @return	The number of widgets drawn.
+ */
+uint8_t VT_Panel_Render(VT_Panel * panel)
+{
+	vt_widget *w = panel->widgets;
+	uint8_t drawn = 0;
+	uint8_t i;
+
+	if (panel->ticks < panel->interval)
+	{
+		return 0;
+	}
+	for (i = panel->count; i > 0; i--, w++)
+	{
+		if (w->flags & VT_WIDGET_DIRTY)
+		{
+			w->flags &= ~VT_WIDGET_DIRTY;
+			w->draw(&w->item);
+			drawn++;
+		}
+	}
+	if (drawn || panel->pending)
+	{
+		panel->pending = 0;
+		panel->ticks = 0;
+		if (VT_screen.cells)
+		{
+			VT_Refresh();
+		}
+		VT_Flush();
+	}
+	return drawn;
 }
@@ -26,8 +26,19 @@
  * SOFTWARE.
  */
 
+#ifndef VT100_H_
+#define VT100_H_
+
 #include <stdint.h>
 
+// Terminal size, used to follow the cursor when text reaches the right margin
+#ifndef VT_COLS
+#define VT_COLS	80	///< Columns on the terminal
+#endif
+#ifndef VT_ROWS
+#define VT_ROWS	24	///< Rows on the terminal
+#endif
+
 /**
  * The data intrinsic to a GUI object
  */
@@ -36,10 +47,76 @@ struct gui_item_t {
 	uint8_t	y;				// Y position of GUI item
 	uint8_t	val1;			// 1st value in item
 	uint8_t	val2;			// 2nd value in item
+	uint8_t	prev;			// Value of val2 last drawn plus 1, or VT_ITEM_REDRAW
+	uint8_t	val3;			// 3rd value, for items that need one
+	uint16_t	val16;		// 16-bit value, for items that need one
+	uint16_t	prev16;		// Value of val16 last drawn, for items that use it
+	uint8_t	*data;			// Buffer the caller gives the item, or NULL
 };
 
+/**
+ * gui_item prev value that makes the next draw call redraw the whole item.
+ * Set it after clearing the screen or attaching a screen model. It is 0, so
+ * a zeroed or hand-built gui_item is drawn in full the first time. prev
+ * holds the value last drawn plus 1, and a val2 of 255 wraps it back to
+ * VT_ITEM_REDRAW, which only costs a full redraw.
+ */
+#define VT_ITEM_REDRAW	0
+
 typedef struct gui_item_t gui_item;
 
+/**
+ * One character cell of the screen model
+ */
+struct vt_cell_t {
+	char	ch;				// Character in the cell
+	uint8_t	attr;			// Color attributes, see VT_ATTR()
+};
+
+typedef struct vt_cell_t vt_cell;
+
+/**
+ * State of a key decoder, one per input stream
+ */
+struct vt_keys_t {
+	uint8_t	state;			// Where in an escape sequence the decoder is
+	uint8_t	param;			// Number parameter of ESC [ n ~ sequences
+	uint8_t	idle;			// Ticks since the last byte in a sequence
+};
+
+typedef struct vt_keys_t VT_Keys;
+
+/**
+ * A GUI item in a panel, with the functions that handle and draw it
+ */
+struct vt_widget_t {
+	gui_item	item;		// The GUI item itself
+	int8_t	(*handle)(uint8_t, gui_item *);	// Key handler, NULL if display only
+	void	(*draw)(gui_item *);	// Draw function
+	uint8_t	flags;			// VT_WIDGET_* flags
+};
+
+typedef struct vt_widget_t vt_widget;
+
+#define VT_WIDGET_DIRTY	0x01	///< Needs drawing on the next render
+
+/**
+ * A set of widgets drawn together, with one of them taking key input
+ */
+struct vt_panel_t {
+	vt_widget	*widgets;	// Array of widgets
+	uint8_t	count;			// Number of widgets
+	uint8_t	focus;			// Index of the widget taking key input
+	uint8_t	interval;		// Minimum ticks between renders
+	volatile uint8_t ticks;	// Ticks since the last render
+	uint8_t	pending;		// Key handler output not refreshed or flushed yet
+};
+
+typedef struct vt_panel_t VT_Panel;
+
+// Widest number readout, in digits
+#define VT_NUMBER_DIGITS	5
+
 // Escape Sequences
 // ================
 #define VT_Clear()       VT_Print("\x1B[2J")   ///< Clear screen
@@ -86,7 +163,80 @@ typedef struct gui_item_t gui_item;
 #define VT_STD_BG				VT_BLK
 #define VT_STD_HL				VT_WHT
 
+// Screen model cell attributes
+#define VT_ATTR(fg, bg)	((((fg) - '0') & 0x07) | ((((bg) - '0') & 0x07) << 3))
+#define VT_ATTR_BRIGHT	0x40	///< Bright (a.k.a. bold) cell
+#define VT_ATTR_DIRTY	0x80	///< Cell changed since the last VT_Refresh
+#define VT_ATTR_STD		VT_ATTR(VT_STD_FG, VT_STD_BG)	///< Standard colors
+#define VT_ATTR_HL		VT_ATTR(VT_STD_HL, VT_STD_BG)	///< Highlight colors
+
+// Key codes from VT_Key_Decode. Other 7-bit bytes are passed through as they
+// are, and received bytes from 0x80 up are dropped so they never look like keys.
+#define VT_KEY_NONE		0x00	///< No key yet, sequence in progress
+#define VT_KEY_BS		0x08	///< Backspace (BS or DEL received)
+#define VT_KEY_ENTER	0x0D	///< Enter (CR, LF, or CR LF received)
+#define VT_KEY_ESC		0x1B	///< Escape key on its own
+#define VT_KEY_UP		0x80	///< Up arrow
+#define VT_KEY_DOWN		0x81	///< Down arrow
+#define VT_KEY_RIGHT	0x82	///< Right arrow
+#define VT_KEY_LEFT		0x83	///< Left arrow
+#define VT_KEY_HOME		0x84	///< Home
+#define VT_KEY_END		0x85	///< End
+#define VT_KEY_PGUP		0x86	///< Page Up
+#define VT_KEY_PGDN		0x87	///< Page Down
+#define VT_KEY_INS		0x88	///< Insert
+#define VT_KEY_DEL		0x89	///< Delete (the key, not the DEL byte)
+#define VT_KEY_F(n)		(0x90 + (n) - 1)	///< Function key F1 to F12
+
+// Ticks of VT_Key_Tick before a lone ESC is taken as the Escape key
+#ifndef VT_KEY_TIMEOUT
+#define VT_KEY_TIMEOUT	2
+#endif
+
+// Terminal features beyond VT100, for VT_SetCaps
+#define VT_CAP_ECH		0x01	///< Erase characters, ESC [ n X (VT220 and up)
+#define VT_CAP_RECT		0x02	///< DECERA and DECFRA rectangles (VT420 and up)
+
+void VT_SetCaps(uint8_t caps);
 void VT_SetTXFunc(void (*TX_func)(char));
+void VT_SetWriteFunc(void (*write_func)(const char *, uint8_t));
+void VT_Flush(void);
+
+/**
+ * @name Output statistics
+ * Build with VT_STATS defined to count the characters sent to the terminal.
+ * VT_TX_US turns a count into line time, at 10 bits per character. For
+ * reference, these are the counts for an 80x24 VT100 with VT_Pos(1, 1) done
+ * first, and the times at 9600 and 115200 baud:
+ *
+ * | Operation                            | Bytes | 9600 baud | 115200 baud |
+ * |--------------------------------------|------:|----------:|------------:|
+ * | HSlide drag 1 step (width 20)        |    25 |     26 ms |     2.2 ms  |
+ * | VSlide drag 1 step (height 10)       |    29 |     30 ms |     2.5 ms  |
+ * | HBar +1 (width 20)                   |    23 |     24 ms |     2.0 ms  |
+ * | HBar 0 to full (width 20)            |    43 |     45 ms |     3.7 ms  |
+ * | Scatter point                        |    36 |     38 ms |     3.1 ms  |
+ * | Chart sample (6 rows)                |    42 |     44 ms |     3.6 ms  |
+ * | Number, last digit changes           |     2 |      2 ms |     0.2 ms  |
+ * | Number, last 3 digits change         |     6 |      6 ms |     0.5 ms  |
+ * | Box 20x6                             |   158 |    165 ms |    13.7 ms  |
+ * | VT_Refresh, full 80x24 of text       |  2039 |   2124 ms |   177   ms  |
+ * | VT_Refresh, one cell changed         |    21 |     22 ms |     1.8 ms  |
+ *
+ * A change to VT100.c that makes any of these bigger should say why.
+ * `make -C host bench` measures these and longer widget sessions, and fails
+ * if any of them got bigger than in host/VTBench.baseline.
+ * @{
+ */
+#ifdef VT_STATS
+uint32_t VT_Bytes(void);
+void VT_Bytes_Reset(void);
+#endif
+
+/// Line time in microseconds for a number of characters, rounded per character
+#define VT_TX_US(bytes, baud) \
+	((uint32_t)(bytes) * ((10000000UL + (baud) / 2) / (baud)))
+/// @}
 
 void VT_SendChar(char c);
 void VT_Print(char *string);
@@ -96,9 +246,15 @@ void VT_Print_Hex_Val(uint8_t hex);
 
 void VT_Pos(uint8_t x, uint8_t y);
 void VT_Move(uint8_t num, char dir);
+void VT_Scroll_Region(uint8_t top, uint8_t bottom);
+void VT_Goto(uint8_t x, uint8_t y);
 void VT_ColorSet(char fg_bg, char color);
+void VT_SetAttr(uint8_t attr);
 
 void VT_Draw_Box(uint8_t width, uint8_t height);
+void VT_Box(uint8_t x, uint8_t y, uint8_t width, uint8_t height);
+void VT_Fill(uint8_t x, uint8_t y, uint8_t w, uint8_t h, char c);
+#define VT_Clear_Rect(x, y, w, h)	VT_Fill((x), (y), (w), (h), ' ')
 void Show_Characters(void);
 
 void VT_HSlide_Init(uint8_t x, uint8_t y, uint8_t width, gui_item * val);
@@ -115,3 +271,36 @@ void VT_HBar_Draw(gui_item * values);
 void VT_Scatter_Init(uint8_t x, uint8_t y, uint8_t h, uint8_t w, gui_item * val);
 void VT_Scatter_Update(uint8_t x, uint8_t y, gui_item * val);
 void VT_Scatter_Clear(gui_item * val);
+
+void VT_Chart_Init(uint8_t x, uint8_t y, uint8_t width, uint8_t height,
+		uint8_t * samples, gui_item * val);
+void VT_Chart_Push(gui_item * val, uint8_t value);
+void VT_Chart_Add(gui_item * val, uint8_t value);
+void VT_Chart_Draw(gui_item * val);
+
+void VT_Number_Init(uint8_t x, uint8_t y, uint8_t digits, gui_item * val);
+void VT_Number_Set(gui_item * val, uint16_t value);
+void VT_Number_Draw(gui_item * val);
+
+void VT_Screen_Init(vt_cell * cells, uint8_t cols, uint8_t rows);
+void VT_Screen_Invalidate(void);
+void VT_Screen_SetAttr(uint8_t attr);
+void VT_Screen_Put(uint8_t x, uint8_t y, char c);
+void VT_Screen_Print(uint8_t x, uint8_t y, char *string);
+void VT_Screen_Fill(uint8_t x, uint8_t y, uint8_t w, uint8_t h, char c);
+void VT_Refresh(void);
+
+void VT_Key_Init(VT_Keys * keys);
+uint8_t VT_Key_Decode(VT_Keys * keys, uint8_t c);
+uint8_t VT_Key_Tick(VT_Keys * keys);
+
+void VT_Panel_Init(VT_Panel * panel, vt_widget * widgets, uint8_t count,
+		uint8_t interval);
+void VT_Panel_Invalidate(VT_Panel * panel);
+void VT_Panel_Set(VT_Panel * panel, uint8_t index, uint8_t value);
+void VT_Panel_Set16(VT_Panel * panel, uint8_t index, uint16_t value);
+void VT_Panel_Key(VT_Panel * panel, uint8_t key);
+void VT_Panel_Tick(VT_Panel * panel);
+uint8_t VT_Panel_Render(VT_Panel * panel);
+
+#endif /* VT100_H_ */
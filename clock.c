@@ -0,0 +1,215 @@
+/*
+ * @file clock.c
+ * @brief Clock configuration record and clock-aware delays
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-10
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <msp430.h>
+#include <stdint.h>
+#include "clock.h"
+
+/// Power-up DCO frequency. This is the top of the datasheet range, so
+/// delays come out long rather than short before a DCO setter is called.
+#define CLOCK_DEFAULT_HZ  1500000UL
+
+/// Frequencies of the calibrated DCO settings, indexed by TLV_DCO_*
+static const uint32_t Clock_dco_hz[TLV_DCO_COUNT] = {
+  1000000UL,
+  8000000UL,
+  12000000UL,
+  16000000UL,
+};
+
+/// Drivers to tell about clock changes
+static void (*Clock_notifiers[CLOCK_MAX_NOTIFIERS])(uint8_t event);
+
+Clock_Cfg Clock_cfg = {
+  CLOCK_DEFAULT_HZ,
+  CLOCK_DEFAULT_HZ,
+  (CLOCK_DEFAULT_HZ + 999999UL) / 1000000UL,
+  CLOCK_DCO_DEFAULT,
+};
+
+bool Clock_Register(void (*notify)(uint8_t event))
+{
+  uint8_t i;
+
+  for (i = 0; i < CLOCK_MAX_NOTIFIERS; i++)
+  {
+    if (!Clock_notifiers[i] || (Clock_notifiers[i] == notify))
+    {
+      Clock_notifiers[i] = notify;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Call every registered notifier.
+ * @param event CLOCK_PRE_CHANGE or CLOCK_POST_CHANGE.
+ */
+static void Clock_Notify(uint8_t event)
+{
+  uint8_t i;
+
+  for (i = 0; (i < CLOCK_MAX_NOTIFIERS) && Clock_notifiers[i]; i++)
+  {
+    Clock_notifiers[i](event);
+  }
+}
+
+bool Clock_Switch(uint8_t freq)
+{
+  uint16_t sr;
+
+  if (!TLV_HasDCO(freq))
+  {
+    return false;
+  }
+  Clock_Notify(CLOCK_PRE_CHANGE);
+
+  sr = __get_SR_register();
+  __disable_interrupt();
+  DCOCTL = 0;                     // Lowest DCOx/MODx while changing RSEL
+  BCSCTL1 = TLV_cal.bc1[freq];
+  DCOCTL = TLV_cal.dco[freq];
+  Clock_Update(freq);
+  if (sr & GIE)
+  {
+    __enable_interrupt();
+  }
+
+  Clock_Notify(CLOCK_POST_CHANGE);
+  return true;
+}
+
+uint8_t Clock_UARTDividers(uint32_t clk_hz, uint32_t baud, uint16_t *br)
+{
+  uint32_t n16 = (clk_hz << 4) / baud;    // Division factor N, times 16
+  uint8_t mod;
+
+  if (n16 >= (16UL << 4))
+  {
+    // Oversampling: UCBRx = INT(N/16), UCBRFx = ROUND(FRAC(N/16) * 16)
+    *br = n16 >> 8;
+    mod = ((n16 & 0xFF) + 8) >> 4;
+    if (mod > 15)
+    {
+      mod = 15;
+    }
+    return (mod << 4) | UCOS16;
+  }
+  // Low frequency: UCBRx = INT(N), UCBRSx = ROUND(FRAC(N) * 8)
+  *br = n16 >> 4;
+  mod = ((n16 & 0x0F) + 1) >> 1;
+  if (mod > 7)
+  {
+    mod = 7;
+  }
+  return mod << 1;
+}
+
+void Clock_Update(uint8_t dco)
+{
+  uint32_t hz = (dco < TLV_DCO_COUNT) ? Clock_dco_hz[dco] : CLOCK_DEFAULT_HZ;
+
+  Clock_cfg.dco = dco;
+  Clock_cfg.mclk_hz = hz >> ((BCSCTL2 & DIVM_3) >> 4);
+  Clock_cfg.smclk_hz = hz >> ((BCSCTL2 & DIVS_3) >> 1);
+  Clock_cfg.mclk_mhz = (Clock_cfg.mclk_hz + 999999UL) / 1000000UL;
+}
+
+/**
+ * Spin for 4 cycles per count.
+ * @param n Number of loops, must not be 0.
+ */
+static inline void Clock_Loop(uint16_t n)
+{
+#ifdef SIM_HOST
+  __delay_cycles((uint32_t)n << 2);
+#else
+  __asm__ __volatile__ (
+      "1: \n"
+      " nop \n"
+      " dec        %[n] \n"
+      " jne        1b \n"
+      : [n] "+r"(n));
+#endif
+}
+
+void Clock_DelayCycles(uint32_t cycles)
+{
+  cycles >>= 2;
+  while (cycles > 0xFFFF)
+  {
+    Clock_Loop(0xFFFF);
+    cycles -= 0xFFFF;
+  }
+  if (cycles)
+  {
+    Clock_Loop(cycles);
+  }
+}
+
+/**
+ * Multiply by the MCLK frequency in MHz.
+ * Shift and add, since the G2xx parts have no hardware multiplier and
+ * mclk_mhz is only a few bits long.
+ * @param n The value to multiply.
+ */
+static uint32_t Clock_MulMHz(uint32_t n)
+{
+  uint32_t result = 0;
+  uint8_t mhz = Clock_cfg.mclk_mhz;
+
+  while (mhz)
+  {
+    if (mhz & 1)
+    {
+      result += n;
+    }
+    n <<= 1;
+    mhz >>= 1;
+  }
+  return result;
+}
+
+void Clock_DelayUs(uint16_t us)
+{
+  Clock_DelayCycles(Clock_MulMHz(us));
+}
+
+void Clock_DelayMs(uint16_t ms)
+{
+  uint32_t per_ms = Clock_MulMHz(1000);
+
+  while (ms--)
+  {
+    Clock_DelayCycles(per_ms);
+  }
+}
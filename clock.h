@@ -2,6 +2,133 @@
 #define _CLOCK_H_
 
 #include <msp430.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "TLV.h"
+
+/**
+ * Clock configuration record.
+ * Kept up to date by DCOSet (and the DCO*MHz setters), so delays and drivers
+ * can work out timings for whatever clock is running. Frequencies assume
+ * MCLK and SMCLK are sourced from the DCO.
+ */
+struct clock_cfg_t {
+	uint32_t mclk_hz;               // MCLK frequency
+	uint32_t smclk_hz;              // SMCLK frequency
+	uint8_t mclk_mhz;               // MCLK frequency in MHz, rounded up
+	uint8_t dco;                    // TLV_DCO_* in use, or CLOCK_DCO_DEFAULT
+};
+
+typedef struct clock_cfg_t Clock_Cfg;
+
+/// Clock_cfg.dco value for the uncalibrated power-up DCO (about 1.1 MHz)
+#define CLOCK_DCO_DEFAULT  0xFF
+
+/// The current clock configuration
+extern Clock_Cfg Clock_cfg;
+
+/// @name Events passed to clock notifiers
+/// @{
+#define CLOCK_PRE_CHANGE   0  ///< About to change, finish up and hold off
+#define CLOCK_POST_CHANGE  1  ///< Changed, Clock_cfg has the new frequencies
+/// @}
+
+#ifndef CLOCK_MAX_NOTIFIERS
+#define CLOCK_MAX_NOTIFIERS 4
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Register a driver to be told about clock changes.
+ * The function is called with CLOCK_PRE_CHANGE before the clock changes, so
+ * the driver can let anything in flight finish and stop its peripheral, and
+ * with CLOCK_POST_CHANGE afterwards to recompute its dividers from Clock_cfg
+ * and start again. UARTA0_ClockNotify, RS485A_ClockNotify, and
+ * ADC10_ClockNotify are made for this.
+ * @param notify The function to call.
+ * @returns False if CLOCK_MAX_NOTIFIERS are already registered.
+ */
+bool Clock_Register(void (*notify)(uint8_t event));
+
+/**
+ * Switch the DCO to one of the calibrated frequencies.
+ * Registered drivers are notified before and after the change, and Clock_cfg
+ * is updated. Can be called as often as needed, for example to run at 16 MHz
+ * during bursts of work and drop to 1 MHz before sleeping.
+ * @param freq One of TLV_DCO_1MHZ, TLV_DCO_8MHZ, TLV_DCO_12MHZ, TLV_DCO_16MHZ.
+ * @returns False if there is no valid calibration for freq. The clock is left
+ *    alone and no drivers are notified in that case.
+ */
+bool Clock_Switch(uint8_t freq);
+
+/**
+ * Work out USCI_A UART divider settings for a baud rate.
+ * Oversampling is used when the clock is at least 16 times the baud rate.
+ * @param clk_hz The BRCLK frequency.
+ * @param baud The baud rate.
+ * @param br Set to the UCAxBR1:UCAxBR0 value.
+ * @returns The UCAxMCTL value.
+ */
+uint8_t Clock_UARTDividers(uint32_t clk_hz, uint32_t baud, uint16_t *br);
+
+/**
+ * Update Clock_cfg after a DCO or divider change.
+ * Reads the MCLK and SMCLK dividers back from BCSCTL2.
+ * @param dco One of TLV_DCO_1MHZ, etc., or CLOCK_DCO_DEFAULT.
+ */
+void Clock_Update(uint8_t dco);
+
+/**
+ * Busy-wait for at least a number of MCLK cycles.
+ * @param cycles Number of cycles. About 20 cycles of call overhead are
+ *    included, so short waits come out a little long.
+ */
+void Clock_DelayCycles(uint32_t cycles);
+
+/**
+ * Busy-wait for at least a number of microseconds at the current MCLK.
+ * @param us Number of microseconds.
+ */
+void Clock_DelayUs(uint16_t us);
+
+/**
+ * Busy-wait for at least a number of milliseconds at the current MCLK.
+ * @param ms Number of milliseconds.
+ */
+void Clock_DelayMs(uint16_t ms);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+/**
+ * @name Delays
+ * If the application runs MCLK at one fixed frequency, define CLOCK_MCLK_HZ
+ * to it (e.g. -DCLOCK_MCLK_HZ=16000000). Delays with constant arguments then
+ * expand to a single __delay_cycles with the exact cycle count, and cost no
+ * more than the wait itself. Otherwise, or for non-constant arguments, the
+ * delay is worked out from Clock_cfg at run time, so it stays right when the
+ * DCO setters change the clock.
+ * @{
+ */
+#ifdef CLOCK_MCLK_HZ
+#define delay_cycles(n) (__builtin_constant_p(n) ? \
+	__delay_cycles(n) : Clock_DelayCycles(n))
+#define delay_us(us) (__builtin_constant_p(us) ? \
+	__delay_cycles((uint32_t)(us) * ((CLOCK_MCLK_HZ + 999999UL) / 1000000UL)) : \
+	Clock_DelayUs(us))
+#define delay_ms(ms) (__builtin_constant_p(ms) ? \
+	__delay_cycles((uint32_t)(ms) * ((CLOCK_MCLK_HZ + 999UL) / 1000UL)) : \
+	Clock_DelayMs(ms))
+#else
+#define delay_cycles(n) Clock_DelayCycles(n)
+#define delay_us(us)    Clock_DelayUs(us)
+#define delay_ms(ms)    Clock_DelayMs(ms)
+#endif
+/// @}
 
 /// Turn off Watchdog Timer
 static inline void WatchdogOff()
@@ -9,39 +136,37 @@ static inline void WatchdogOff()
 	WDTCTL = WDTPW | WDTHOLD;
 }
 
+/**
+ * Set DCO to one of the calibrated frequencies.
+ * Uses the calibration cached by TLV_Init, which is run on first use.
+ * @see Clock_Switch
+ */
+static inline bool DCOSet(uint8_t freq)
+{
+	return Clock_Switch(freq);
+}
+
 /// Set DCO to Calibrated 1 MHz frequency
-static inline void DCO1MHz()
+static inline bool DCO1MHz()
 {
-	const char *CALDCO_1MHZ = (char *)(TLV_DCO_30_TAG_ + 0x02 + CAL_DCO_1MHZ);
-	const char *CALBC1_1MHZ = (char *)(TLV_DCO_30_TAG_ + 0x02 + CAL_BC1_1MHZ);
-	DCOCTL = *CALDCO_1MHZ; // Hard code for now
-	BCSCTL1 = *CALBC1_1MHZ; // Hard code for now
+	return DCOSet(TLV_DCO_1MHZ);
 }
 
 /// Set DCO to Calibrated 8 MHz frequency
-static inline void DCO8MHz()
+static inline bool DCO8MHz()
 {
-	const char *CALDCO_8MHZ = (char *)(TLV_DCO_30_TAG_ + 0x02 + CAL_DCO_8MHZ);
-	const char *CALBC1_8MHZ = (char *)(TLV_DCO_30_TAG_ + 0x02 + CAL_BC1_8MHZ);
-	DCOCTL = *CALDCO_8MHZ; // Hard code for now
-	BCSCTL1 = *CALBC1_8MHZ; // Hard code for now
+	return DCOSet(TLV_DCO_8MHZ);
 }
 
 /// Set DCO to Calibrated 12 MHz frequency
-static inline void DCO12MHz()
+static inline bool DCO12MHz()
 {
-	const char *CALDCO_12MHZ = (char *)(TLV_DCO_30_TAG_ + 0x02 + CAL_DCO_12MHZ);
-	const char *CALBC1_12MHZ = (char *)(TLV_DCO_30_TAG_ + 0x02 + CAL_BC1_12MHZ);
-	DCOCTL = *CALDCO_12MHZ; // Hard code for now
-	BCSCTL1 = *CALBC1_12MHZ; // Hard code for now
+	return DCOSet(TLV_DCO_12MHZ);
 }
 
 /// Set DCO to Calibrated 16 MHz frequency
-static inline void DCO16MHz()
+static inline bool DCO16MHz()
 {
-	const char *CALDCO_16MHZ = (char *)(TLV_DCO_30_TAG_ + 0x02 + CAL_DCO_16MHZ);
-	const char *CALBC1_16MHZ = (char *)(TLV_DCO_30_TAG_ + 0x02 + CAL_BC1_16MHZ);
-	DCOCTL = *CALDCO_16MHZ; // Hard code for now
-	BCSCTL1 = *CALBC1_16MHZ; // Hard code for now
+	return DCOSet(TLV_DCO_16MHZ);
 }
 #endif
@@ -29,7 +29,25 @@
  */
 
 #include "ADC10.h"
-#include "../utils.h"
+#include "../clock.h"
+#include "../TLV.h"
+
+/// Settling time of the internal reference after REFON, in microseconds
+#ifndef ADC10_REF_SETTLE_US
+#define ADC10_REF_SETTLE_US 30
+#endif
+
+/// Highest ADC10CLK frequency in the datasheet, in units of 100 kHz
+#define ADC10_MAX_CLK_100KHZ 63
+
+/// Sample time the temperature sensor needs, in microseconds
+#define ADC10_TEMP_SAMPLE_US 30
+
+/// ADC10DIV bits keeping ADC10CLK (MCLK / divider) within spec
+static uint16_t ADC10_clock_div;
+
+/// ADC10DIV bits making 64 ADC10CLK cycles long enough for the temp sensor
+static uint16_t ADC10_temp_div;
 
 /// Value to multiply raw ADC value by for temperature
 static float ADC10_temp_compensation_scalar;
@@ -37,34 +55,223 @@ static float ADC10_temp_compensation_scalar;
 /// Value to add to scaled ADC value
 static float ADC10_temp_compensation_offset;
 
-int16_t ADC10_AnalogRead(const uint8_t channel)
+void ADC10_ClockNotify(uint8_t event)
 {
-  ADC10CTL0 |= ADC10ON | ADC10SHT_0;
-  ADC10CTL1 = (channel << 12) | ADC10SSEL_2;
-  ADC10CTL0 |= ADC10SC | ENC;
-  DelayCycles(64);
-  while (ADC10CTL1 & ADC10BUSY);
+  uint8_t mhz = Clock_cfg.mclk_mhz;
+  uint8_t div;
+
+  if (event != CLOCK_POST_CHANGE)
+  {
+    return;
+  }
+
+  // Divider for conversions, rounded up
+  div = (mhz * 10 + ADC10_MAX_CLK_100KHZ - 1) / ADC10_MAX_CLK_100KHZ;
+  ADC10_clock_div = (uint16_t)(div - 1) << 5;
+
+  // Divider for temperature, so 64 cycles is at least the sample time
+  div = ((uint16_t)mhz * ADC10_TEMP_SAMPLE_US + 63) >> 6;
+  if (div < 1)
+  {
+    div = 1;
+  } else if (div > 8) {
+    div = 8;
+  }
+  ADC10_temp_div = (uint16_t)(div - 1) << 5;
+}
+
+/// ADC10_pending value when no polled conversion is in progress
+#define ADC10_IDLE 0xFF
+
+/// ADC10_pending value for a temperature conversion
+#define ADC10_TEMP 0x10
+
+/// Channel of the polled conversion in progress, ADC10_TEMP, or ADC10_IDLE
+static uint8_t ADC10_pending = ADC10_IDLE;
+
+/// Set by ADC10_ISR when a polled conversion finishes. Taking the interrupt
+/// clears ADC10IFG, so the poll can't look at that instead.
+static volatile bool ADC10_done;
+
+/**
+ * Wait for the conversion in progress.
+ * Polls ADC10IFG, which is only set once the result is in ADC10MEM, so no
+ * guard time is needed before polling, whatever ADC10CLK is.
+ */
+static uint16_t ADC10_Wait(void)
+{
+  while (!(ADC10CTL0 & ADC10IFG));
   return ADC10MEM;
+}
 
+/**
+ * Start a single conversion on an analog channel.
+ * @param channel The channel number to read from (0 to 15)
+ */
+static void ADC10_AnalogStart(const uint8_t channel)
+{
+  // Control registers can only be changed with ENC cleared
+  ADC10CTL0 &= ~ENC;
+  ADC10CTL0 = (ADC10CTL0 & ~(ADC10SHT_3 | ADC10IFG | ADC10IE))
+      | ADC10ON | ADC10SHT_0;
+  ADC10CTL1 = (channel << 12) | ADC10SSEL_2 | ADC10_clock_div;
+  ADC10CTL0 |= ADC10SC | ENC;
 }
 
-float ADC10_TempRead()
+/**
+ * Start a conversion of the temperature sensor.
+ * If the reference is off, this turns it on and waits for it to settle.
+ */
+static void ADC10_TempStart(void)
 {
-  ADC10CTL0 |= ADC10ON | REFON | ADC10SHT_2;
-  ADC10CTL1 = (10 << 12) | ADC10SSEL_2;
+  ADC10CTL0 &= ~ENC;
+  if (!(ADC10CTL0 & REFON))
+  {
+    ADC10CTL0 |= REFON;
+    delay_us(ADC10_REF_SETTLE_US);
+  }
+  ADC10CTL0 = (ADC10CTL0 & ~(ADC10IFG | ADC10IE)) | ADC10ON | ADC10SHT_3;
+  ADC10CTL1 = (10 << 12) | ADC10SSEL_2 | ADC10_temp_div;
   ADC10CTL0 |= ADC10SC | ENC;
+}
+
+/**
+ * Start a polled conversion, with the interrupt on so the CPU can sleep
+ * until it finishes.
+ * @param pending Channel number, or ADC10_TEMP.
+ */
+static void ADC10_PollStart(uint8_t pending)
+{
+  ADC10_done = false;
+  if (pending == ADC10_TEMP)
+  {
+    ADC10_TempStart();
+  } else {
+    ADC10_AnalogStart(pending);
+  }
+  ADC10_pending = pending;
+  ADC10CTL0 |= ADC10IE;
+}
+
+/**
+ * Check if the polled conversion for a channel has finished.
+ * @param pending Channel number, or ADC10_TEMP.
+ */
+static bool ADC10_PollDone(uint8_t pending)
+{
+  if ((ADC10_pending != pending)
+      || !(ADC10_done || (ADC10CTL0 & ADC10IFG)))
+  {
+    return false;
+  }
+  ADC10CTL0 &= ~ADC10IE;
+  ADC10_pending = ADC10_IDLE;
+  return true;
+}
+
+void ADC10_ISR(void)
+{
+  ADC10CTL0 &= ~ADC10IE;
+  ADC10_done = true;
+}
+
+/**
+ * Convert a raw temperature sensor reading to degrees celsius.
+ */
+static float ADC10_TempScale(uint16_t raw)
+{
+  return raw * ADC10_temp_compensation_scalar + ADC10_temp_compensation_offset;
+}
+
+int16_t ADC10_AnalogRead(const uint8_t channel)
+{
+  ADC10_pending = ADC10_IDLE;
+  ADC10_AnalogStart(channel);
+  return ADC10_Wait();
+}
+
+bool ADC10_AnalogPoll(const uint8_t channel, uint16_t *result)
+{
+  if (ADC10_pending == ADC10_IDLE)
+  {
+    ADC10_PollStart(channel);
+    return false;
+  }
+  if (!ADC10_PollDone(channel))
+  {
+    return false;
+  }
+  *result = ADC10MEM;
+  return true;
+}
+
+void ADC10_AnalogReadBlock(
+    const uint8_t channel,
+    uint16_t *samples,
+    const uint8_t count)
+{
+  ADC10_pending = ADC10_IDLE;
+  // Control registers can only be changed with ENC cleared
+  ADC10CTL0 &= ~ENC;
   while (ADC10CTL1 & ADC10BUSY);
-  return ADC10MEM * ADC10_temp_compensation_scalar
-    + ADC10_temp_compensation_offset;
+
+  // Keep the reference the caller set up, as ADC10_AnalogStart does
+  ADC10CTL0 = (ADC10CTL0 & ~(ADC10SHT_3 | ADC10IFG | ADC10IE))
+      | ADC10ON | ADC10SHT_0 | MSC;
+  ADC10CTL1 = (channel << 12) | ADC10SSEL_2 | ADC10_clock_div | CONSEQ_2;
+  ADC10DTC0 = 0;                  // One block, stop when it's full
+  ADC10DTC1 = count;
+  ADC10SA = (uintptr_t)samples;
+  ADC10CTL0 |= ADC10SC | ENC;
+
+  // DTC sets ADC10IFG once the whole block has been written
+  while (!(ADC10CTL0 & ADC10IFG));
+
+  // Stop the repeat sequence and hand the ADC back to single conversions
+  ADC10CTL0 &= ~(ENC | MSC | ADC10IFG);
+  ADC10DTC1 = 0;
 }
 
-void ADC10_TempInit()
+float ADC10_TempRead()
+{
+  ADC10_pending = ADC10_IDLE;
+  ADC10_TempStart();
+  return ADC10_TempScale(ADC10_Wait());
+}
+
+bool ADC10_TempPoll(float *result)
 {
-  // Hard code in TLV lookup
-	const char *CALADC_15T85 = (char *)(TLV_ADC10_1_TAG_ + 0x02 + CAL_ADC_15T85);
-	const char *CALADC_15T30 = (char *)(TLV_ADC10_1_TAG_ + 0x02 + CAL_ADC_15T30);
+  if (ADC10_pending == ADC10_IDLE)
+  {
+    ADC10_PollStart(ADC10_TEMP);
+    return false;
+  }
+  if (!ADC10_PollDone(ADC10_TEMP))
+  {
+    return false;
+  }
+  *result = ADC10_TempScale(ADC10MEM);
+  return true;
+}
+
+bool ADC10_TempInit()
+{
+  uint16_t t30;
+  uint16_t t85;
+
+  if (!(TLV_cal.flags & TLV_CHECKED))
+  {
+    TLV_Init();
+  }
+  if (!(TLV_cal.flags & TLV_HAS_ADC))
+  {
+    return false;
+  }
+  t30 = TLV_cal.adc_15t30;
+  t85 = TLV_cal.adc_15t85;
 
   // Calculate scalar and offset from calibrated values - this will take a while
-  ADC10_temp_compensation_scalar = (85.0f - 30.0f)/(*CALADC_15T85 - *CALADC_15T30);
-  ADC10_temp_compensation_offset = 30.0f - ADC10_temp_compensation_scalar * *CALADC_15T30;
+  ADC10_temp_compensation_scalar = (85.0f - 30.0f)/(t85 - t30);
+  ADC10_temp_compensation_offset = 30.0f - ADC10_temp_compensation_scalar * t30;
+  return true;
 }
@@ -33,6 +33,17 @@
 
 #include <msp430.h>
 #include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Clock change notifier, for Clock_Register.
+ * ADC10CLK is MCLK, which is only allowed up to 6.3 MHz, so this picks the
+ * ADC10 clock divider for the new MCLK. It also picks a separate divider for
+ * temperature reads, which need a 30 us sample time. Call it once with
+ * CLOCK_POST_CHANGE at start-up if the clock was set before registering.
+ * @param event CLOCK_PRE_CHANGE or CLOCK_POST_CHANGE.
+ */
+void ADC10_ClockNotify(uint8_t event);
 
 /**
  * Read from the given analog channel.
@@ -41,14 +52,62 @@
  */
 int16_t ADC10_AnalogRead(const uint8_t channel);
 
+/**
+ * Read from the given analog channel without blocking.
+ * The first call starts a conversion and later calls check on it, so this
+ * is called until it returns true, e.g. from PT_WAIT_UNTIL. Only one
+ * conversion runs at a time: a call for another channel waits for the
+ * conversion in progress to be collected first. Blocking reads abandon any
+ * conversion in progress.
+ * The conversion finishes with an interrupt, so the CPU can sleep while it
+ * runs: ADC10_ISR must be inserted into the ADC10_VECTOR ISR, waking the CPU
+ * (with SCHED_WAKE_ON_EXIT when using Sched.h).
+ * @param channel The channel number to read from (0 to 15)
+ * @param result Set to the raw 10-bit analog value once it is ready
+ * @returns True once result has been set
+ */
+bool ADC10_AnalogPoll(const uint8_t channel, uint16_t *result);
+
+/**
+ * Read a block of samples from the given analog channel.
+ * Uses repeat-single-channel mode with the data transfer controller, so
+ * samples are taken back to back with no CPU work between conversions. The
+ * block can then be handed to the Filter.h routines.
+ * @param channel The channel number to read from (0 to 15)
+ * @param samples Buffer for the raw 10-bit samples
+ * @param count Number of samples to take (1 to 255)
+ */
+void ADC10_AnalogReadBlock(
+    const uint8_t channel,
+    uint16_t *samples,
+    const uint8_t count);
+
 /**
  * Read the internal temperature sensor.
  * @returns the temperature in degrees celsius.
  */
 float ADC10_TempRead();
 
-/// Initialize the temperature compensation constants
-void ADC10_TempInit();
+/**
+ * Read the internal temperature sensor without blocking.
+ * Works like ADC10_AnalogPoll. The first call still waits for the reference
+ * to settle if it was off.
+ * @param result Set to the temperature in degrees celsius once it is ready
+ * @returns True once result has been set
+ */
+bool ADC10_TempPoll(float *result);
+
+/**
+ * ISR for a polled conversion finishing. Only ADC10_AnalogPoll and
+ * ADC10_TempPoll turn the interrupt on.
+ */
+void ADC10_ISR(void);
+
+/**
+ * Initialize the temperature compensation constants from the TLV calibration.
+ * @returns False if the TLV segment is corrupt or has no ADC10 calibration.
+ */
+bool ADC10_TempInit();
 
 static inline void ADC10_EnableAnalog(const uint8_t channel)
 {
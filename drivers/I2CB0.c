@@ -0,0 +1,241 @@
+/*
+ * @file I2CB0.c
+ * @brief Interrupt-driven I2C master on MSP430 USCI B0.
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-15
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "I2CB0.h"
+
+/// Transfer being run, followed by the rest of the queue
+static I2CB0_Xfer *I2CB0_head;
+
+/// Last transfer in the queue
+static I2CB0_Xfer *I2CB0_tail;
+
+/// Next byte to write, and bytes left to write, of the head transfer
+static const uint8_t *I2CB0_tx;
+static uint16_t I2CB0_tx_left;
+
+/// Next byte to read, and bytes left to read, of the head transfer
+static uint8_t *I2CB0_rx;
+static uint16_t I2CB0_rx_left;
+
+void I2CB0_Init(uint8_t clock_source, uint16_t prescaler)
+{
+  I2CB0_head = 0;
+  UCB0CTL1 = clock_source | UCSWRST;
+  UCB0CTL0 = UCMST | UCMODE_3 | UCSYNC;
+  UCB0BR0 = prescaler & 0xFF;
+  UCB0BR1 = prescaler >> 8;
+  UCB0CTL1 &= ~UCSWRST;
+  UCB0I2CIE = UCNACKIE;
+}
+
+//=============================================================================
+// Transfer Sequencing
+//=============================================================================
+
+/*
+ * Send a (repeated) START with the read bit set.
+ */
+static void I2CB0_StartRead(void)
+{
+  IE2 = (IE2 & ~UCB0TXIE) | UCB0RXIE;
+  UCB0CTL1 &= ~UCTR;
+  UCB0CTL1 |= UCTXSTT;
+  // A single byte has to be NACKed, so ask for the STOP while it comes in.
+  // If the address was NACKed, I2CB0_State_ISR sends the STOP instead.
+  if (I2CB0_rx_left == 1)
+  {
+    while (UCB0CTL1 & UCTXSTT);
+    if (!(UCB0STAT & UCNACKIFG))
+    {
+      UCB0CTL1 |= UCTXSTP;
+    }
+  }
+}
+
+/*
+ * Address the head transfer's device and start writing, or reading if
+ * there is nothing to write.
+ */
+static void I2CB0_Begin(void)
+{
+  I2CB0_Xfer *xfer = I2CB0_head;
+
+  I2CB0_tx = xfer->tx;
+  I2CB0_tx_left = xfer->tx_len;
+  I2CB0_rx = xfer->rx;
+  I2CB0_rx_left = xfer->rx_len;
+  // The last transfer's STOP may still be going out, after a byte that
+  // nobody wants if it ended early
+  while (UCB0CTL1 & UCTXSTP);
+  IFG2 &= ~UCB0RXIFG;
+  UCB0I2CSA = xfer->address;
+  if (I2CB0_tx_left || !I2CB0_rx_left)
+  {
+    IE2 |= UCB0TXIE;
+    UCB0CTL1 |= UCTR | UCTXSTT;
+  } else {
+    I2CB0_StartRead();
+  }
+}
+
+/*
+ * Finish the head transfer and start the next one.
+ * @param status I2CB0_DONE or I2CB0_NACK.
+ * @returns True, for the ISR to pass on.
+ */
+static bool I2CB0_Finish(uint8_t status)
+{
+  I2CB0_Xfer *xfer = I2CB0_head;
+
+  IE2 &= ~(UCB0TXIE | UCB0RXIE);
+  // Start the next one before the callback, to keep the bus busy
+  I2CB0_head = xfer->next;
+  if (I2CB0_head)
+  {
+    I2CB0_Begin();
+  }
+  xfer->status = status;
+  if (xfer->callback)
+  {
+    xfer->callback(xfer);
+  }
+  return true;
+}
+
+void I2CB0_Queue(I2CB0_Xfer *xfer)
+{
+  uint16_t sr = __get_SR_register();
+
+  __disable_interrupt();
+  xfer->next = 0;
+  xfer->status = I2CB0_QUEUED;
+  if (I2CB0_head)
+  {
+    I2CB0_tail->next = xfer;
+  } else {
+    I2CB0_head = xfer;
+    I2CB0_Begin();
+  }
+  I2CB0_tail = xfer;
+  if (sr & GIE)
+  {
+    __enable_interrupt();
+  }
+}
+
+void I2CB0_Wait(I2CB0_Xfer *xfer)
+{
+  uint16_t sr = __get_SR_register();
+
+  __disable_interrupt();
+  while (xfer->status == I2CB0_QUEUED)
+  {
+    __bis_SR_register(I2CB0_LPM_BITS | GIE);
+    __disable_interrupt();
+  }
+  if (sr & GIE)
+  {
+    __enable_interrupt();
+  }
+}
+
+bool I2CB0_Busy(void)
+{
+  return I2CB0_head != 0;
+}
+
+//=============================================================================
+// Interrupts
+//=============================================================================
+
+bool I2CB0_Data_ISR(void)
+{
+  uint8_t status;
+
+  if ((IFG2 & UCB0RXIFG) && (IE2 & UCB0RXIE))
+  {
+    I2CB0_rx_left--;
+    *I2CB0_rx++ = UCB0RXBUF;
+    if (!I2CB0_rx_left)
+    {
+      return I2CB0_Finish(I2CB0_DONE);
+    }
+    // The next byte is the last one: NACK it and STOP
+    if (I2CB0_rx_left == 1)
+    {
+      UCB0CTL1 |= UCTXSTP;
+    }
+    return false;
+  }
+  if (!(IFG2 & UCB0TXIFG) || !(IE2 & UCB0TXIE))
+  {
+    return false;
+  }
+  if (I2CB0_tx_left)
+  {
+    I2CB0_tx_left--;
+    UCB0TXBUF = *I2CB0_tx++;
+    return false;
+  }
+  if (I2CB0_rx_left)
+  {
+    I2CB0_StartRead();
+    return false;
+  }
+
+  // Last byte is in the shift register. Wait for it and the STOP to go out
+  // to find out if it was acknowledged.
+  IE2 &= ~UCB0TXIE;
+  UCB0CTL1 |= UCTXSTP;
+  IFG2 &= ~UCB0TXIFG;
+  while (UCB0CTL1 & UCTXSTP);
+  status = I2CB0_DONE;
+  if (UCB0STAT & UCNACKIFG)
+  {
+    UCB0STAT &= ~UCNACKIFG;
+    status = I2CB0_NACK;
+  }
+  return I2CB0_Finish(status);
+}
+
+bool I2CB0_State_ISR(void)
+{
+  if (!(UCB0STAT & UCNACKIFG))
+  {
+    return false;
+  }
+  UCB0CTL1 |= UCTXSTP;
+  UCB0STAT &= ~UCNACKIFG;
+  IFG2 &= ~UCB0TXIFG;
+  if (!I2CB0_head)
+  {
+    return false;
+  }
+  return I2CB0_Finish(I2CB0_NACK);
+}
@@ -0,0 +1,191 @@
+/*
+ * @file I2CB0.h
+ * @brief Interrupt-driven I2C master on MSP430 USCI B0.
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-15
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @details
+ * Using this Driver
+ * -----------------
+ *
+ *  Transfers are queued and run one after another from the USCI interrupts,
+ *  so the CPU can sleep while bytes go back and forth. Each transfer writes
+ *  tx_len bytes from tx to the device at address, then, after a repeated
+ *  start, reads rx_len bytes into rx. That covers plain writes, plain
+ *  reads, and the usual "write the register number, read the register"
+ *  sensor access. With both lengths 0 the transfer only checks that the
+ *  device answers. When the transfer is done its status becomes I2CB0_DONE,
+ *  or I2CB0_NACK if the device didn't acknowledge, and its callback is run,
+ *  from the ISR.
+ *
+ *  - The I2C pins must be selected first. On the G2553: P1SEL and P1SEL2
+ *    bits 6 (SCL) and 7 (SDA), with pull-ups on the board.
+ *  - I2CB0_Init must be called during initialization of MSP430.
+ *  - I2CB0_Data_ISR must be inserted into the USCIAB0TX_VECTOR ISR, and
+ *    I2CB0_State_ISR into the USCIAB0RX_VECTOR ISR, waking the CPU when they
+ *    return true. On the G2xx, I2C data flags go to the TX vector and NACK
+ *    goes to the RX vector.
+ *  - USCI B0 runs either this driver or SPIB0, not both. UARTA0 shares the
+ *    vectors, so its ISR has to check its own flag.
+ *
+ *  The USCI has no interrupt for the end of a STOP, so a transfer that
+ *  ends in a write waits in the ISR for its last byte and the STOP to go
+ *  out, about 10 SCL periods. Only then is it known whether the last byte
+ *  was acknowledged. A read of one byte waits for the address to be
+ *  acknowledged in the same way, since the STOP has to be asked for while
+ *  that byte is coming in.
+ *
+ *  Example:
+ * ~~~{.c}
+ *
+ * __attribute__((interrupt(USCIAB0TX_VECTOR)))
+ * void USCI_AB0_TX_ISR(void)
+ * {
+ * 	if ((IFG2 & UCA0TXIFG) && (IE2 & UCA0TXIE))
+ * 		UARTA0_TX_ISR();
+ * 	if (I2CB0_Data_ISR())
+ * 		_bic_SR_register_on_exit(I2CB0_LPM_BITS);
+ * }
+ *
+ * __attribute__((interrupt(USCIAB0RX_VECTOR)))
+ * void USCI_AB0_RX_ISR(void)
+ * {
+ * 	if ((IFG2 & UCA0RXIFG) && (IE2 & UCA0RXIE))
+ * 		UARTA0_RX_ISR();
+ * 	if (I2CB0_State_ISR())
+ * 		_bic_SR_register_on_exit(I2CB0_LPM_BITS);
+ * }
+ *
+ * static const uint8_t temp_reg = 0x00;
+ * uint8_t temp[2];
+ * I2CB0_Xfer read_temp = {
+ * 	.address = 0x48,
+ * 	.tx = &temp_reg, .tx_len = 1,
+ * 	.rx = temp, .rx_len = 2,
+ * };
+ *
+ * P1SEL |= BIT6 | BIT7;
+ * P1SEL2 |= BIT6 | BIT7;
+ * I2CB0_Init(I2CB0_SMCLK, 160);    // 100 kHz from 16 MHz
+ * I2CB0_Queue(&read_temp);
+ * I2CB0_Wait(&read_temp);
+ * if (read_temp.status == I2CB0_DONE) {
+ * 	...
+ * }
+ *
+ * ~~~
+ */
+
+#ifndef _I2CB0_H_
+#define _I2CB0_H_
+
+#include <msp430.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/// Low power mode I2CB0_Wait sleeps in. SMCLK has to keep running.
+#ifndef I2CB0_LPM_BITS
+#define I2CB0_LPM_BITS  LPM0_bits
+#endif
+
+/// @name I2C Clock Configuration Constants
+/// @{
+static const uint8_t I2CB0_ACLK  = UCSSEL_1; ///< Use ACLK as clock source
+static const uint8_t I2CB0_SMCLK = UCSSEL_2; ///< Use SMCLK as clock source
+/// @}
+
+/// @name Transfer Status
+/// @{
+#define I2CB0_QUEUED  0 ///< Waiting for or in the middle of its turn
+#define I2CB0_DONE    1 ///< Finished
+#define I2CB0_NACK    2 ///< Stopped early, the device didn't acknowledge
+/// @}
+
+struct i2cb0_xfer_t {
+  struct i2cb0_xfer_t *next;      // Next transfer in the queue
+  const uint8_t *tx;              // Bytes to write
+  uint8_t *rx;                    // Bytes read after tx has been written
+  uint16_t tx_len;
+  uint16_t rx_len;
+  uint8_t address;                // 7-bit device address
+  void (*callback)(struct i2cb0_xfer_t *xfer); // Run when done, or 0
+  volatile uint8_t status;        // I2CB0_QUEUED, I2CB0_DONE or I2CB0_NACK
+};
+
+typedef struct i2cb0_xfer_t I2CB0_Xfer;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Set up USCI B0 as a single-master I2C master with 7-bit addresses.
+ * @param clock_source I2CB0_ACLK or I2CB0_SMCLK.
+ * @param prescaler SCL divider, 4 or more.
+ */
+void I2CB0_Init(uint8_t clock_source, uint16_t prescaler);
+
+/*
+ * Add a transfer to the queue, starting it if the bus is free.
+ * Safe to call from a callback.
+ * @param xfer The transfer. The transfer and its buffers must stay in scope
+ *    until it is done.
+ */
+void I2CB0_Queue(I2CB0_Xfer *xfer);
+
+/*
+ * Sleep until a transfer is done. Not for use in ISRs or callbacks.
+ * Interrupts are left enabled or disabled on return, as they were on entry.
+ * Tasks can use PT_WAIT_UNTIL(pt, xfer.status != I2CB0_QUEUED) instead.
+ * @param xfer The transfer, already queued.
+ */
+void I2CB0_Wait(I2CB0_Xfer *xfer);
+
+/*
+ * Check if any transfers are queued or running.
+ */
+bool I2CB0_Busy(void);
+
+/*
+ * ISR for USCIAB0TX_VECTOR. Does nothing unless UCB0TXIFG or UCB0RXIFG is
+ * set and enabled. Moves the next byte, and finishes the transfer after the
+ * last one.
+ * @returns True if a transfer finished, so the CPU should wake up.
+ */
+bool I2CB0_Data_ISR(void);
+
+/*
+ * ISR for USCIAB0RX_VECTOR. Does nothing unless UCNACKIFG is set.
+ * Sends a STOP and finishes the transfer with I2CB0_NACK.
+ * @returns True if a transfer finished, so the CPU should wake up.
+ */
+bool I2CB0_State_ISR(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif
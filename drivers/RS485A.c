@@ -1,4 +1,5 @@
 #include "RS485A.h"
+#include "../clock.h"
 
 #ifndef RS485A_TX_BUFFER_SIZE
 #define RS485A_TX_BUFFER_SIZE  32
@@ -45,7 +46,7 @@ void RS485A_DisableInterrupts() {
 //=============================================================================
 // UART Transmit Function
 //=============================================================================
-void RS485A_Send(uint8_t data)
+bool RS485A_TrySend(uint8_t data)
 {
 	// Put straight to UART if not yet transmitting
 	if (!RS485A_transmitting)
@@ -53,12 +54,21 @@ void RS485A_Send(uint8_t data)
 		UCA0TXBUF = data;
 		RS485A_transmitting = 1;
 		IE2 |= UCA0TXIE;
-	  // Load data into TX buffer
-	} else {
-		// Make sure the buffer isn't full. Loop continuously if it is.
-    while(FIFO_Full(&RS485A_tx_buffer));
-    FIFO_Put(&RS485A_tx_buffer, data);
+		return true;
+	}
+	// Load data into TX buffer, if there's room
+	if (FIFO_Full(&RS485A_tx_buffer))
+	{
+		return false;
 	}
+	FIFO_Put(&RS485A_tx_buffer, data);
+	return true;
+}
+
+void RS485A_Send(uint8_t data)
+{
+	// Loop continuously while the buffer is full
+	while (!RS485A_TrySend(data));
 }
 
 uint8_t RS485A_Receive()
@@ -71,7 +81,14 @@ uint8_t RS485A_Receive()
 //=============================================================================
 void RS485A_Rx_ISR(void)
 {
+#ifdef RS485A_RX_CRC
+	uint8_t data = UCA0RXBUF;
+
+	FIFO_Put(&RS485A_rx_buffer, data);
+	RS485A_rx_crc = RS485A_RX_CRC(RS485A_rx_crc, data);
+#else
 	FIFO_Put(&RS485A_rx_buffer, UCA0RXBUF);
+#endif
 }
 
 //=============================================================================
@@ -88,3 +105,47 @@ void RS485A_Tx_ISR(void)
 		IE2 &= ~UCA0TXIE;
 	}
 }
+
+
+//=============================================================================
+// Clock Scaling
+//=============================================================================
+
+/// Baud rate to keep when the clock changes, or 0 for fixed dividers
+static uint32_t RS485A_baud;
+
+/// Interrupt enables saved across a clock change
+static uint8_t RS485A_saved_ie;
+
+void RS485A_ClockNotify(uint8_t event)
+{
+  uint16_t br;
+
+  if (!RS485A_baud)
+  {
+    return;
+  }
+  if (event == CLOCK_PRE_CHANGE)
+  {
+    // Let the byte being shifted out finish, without starting another one
+    RS485A_saved_ie = IE2 & (UCA0RXIE | UCA0TXIE);
+    IE2 &= ~UCA0TXIE;
+    while (UCA0STAT & UCBUSY);
+    UCA0CTL1 |= UCSWRST;
+  } else {
+    UCA0MCTL = Clock_UARTDividers(Clock_cfg.smclk_hz, RS485A_baud, &br);
+    UCA0BR0 = br & 0xFF;
+    UCA0BR1 = br >> 8;
+    UCA0CTL1 &= ~UCSWRST;
+    // Reset sets TXIFG, so a pending TX buffer starts sending again
+    IE2 |= RS485A_saved_ie;
+  }
+}
+
+void RS485A_SetBaud(uint32_t baud)
+{
+  RS485A_baud = baud;
+  RS485A_ClockNotify(CLOCK_PRE_CHANGE);
+  UCA0CTL1 = (UCA0CTL1 & ~UCSSEL_3) | RS485A_SMCLK;
+  RS485A_ClockNotify(CLOCK_POST_CHANGE);
+}
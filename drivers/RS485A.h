@@ -4,6 +4,9 @@
 
 #include <msp430.h>
 #include "../FIFO.h"
+#ifdef RS485A_RX_CRC
+#include "../CRC.h"
+#endif
 
 /// @name UART Clock Configuration Constants
 /// @{
@@ -30,6 +33,25 @@ FIFO_Buffer RS485A_tx_buffer;
 
 bool RS485A_transmitting;
 
+#ifdef RS485A_RX_CRC
+/*
+ * Running CRC of received bytes. Define RS485A_RX_CRC as a CRC.h update
+ * function, e.g. -DRS485A_RX_CRC=CRC16_Modbus_Update, and RS485A_Rx_ISR
+ * runs every received byte through it. Call RS485A_CRCReset while the bus
+ * is idle before each frame. A good frame, CRC included, leaves it at 0.
+ */
+volatile uint16_t RS485A_rx_crc;
+
+/*
+ * Restart the receive CRC.
+ * @param init Initial value for the CRC, e.g. CRC16_MODBUS_INIT.
+ */
+static inline void RS485A_CRCReset(uint16_t init)
+{
+  RS485A_rx_crc = init;
+}
+#endif
+
 void RS485A_Init(
     uint8_t clock_source,
     uint8_t clock_prescaler0,
@@ -41,9 +63,43 @@ void RS485A_Init(
     uint8_t oversampling);
 
 void RS485A_Send(uint8_t data);
+
+/*
+ * Send a byte if there is room, without blocking.
+ * @param data Byte to send.
+ * @returns False if the TX buffer is full and the byte was not sent.
+ */
+bool RS485A_TrySend(uint8_t data);
+
+/*
+ * Set the baud rate, worked out from the SMCLK frequency in Clock_cfg.
+ * Switches the clock source to SMCLK. Once this has been called,
+ * RS485A_ClockNotify keeps the baud rate right across Clock_Switch calls.
+ * @param baud Baud rate, e.g. 9600.
+ */
+void RS485A_SetBaud(uint32_t baud);
+
+/*
+ * Clock change notifier, for Clock_Register.
+ * Before a change, waits for the byte in flight to finish and holds the USCI
+ * in reset. After, recomputes the dividers for the new SMCLK and restarts.
+ * Does nothing unless RS485A_SetBaud has been called.
+ * @param event CLOCK_PRE_CHANGE or CLOCK_POST_CHANGE.
+ */
+void RS485A_ClockNotify(uint8_t event);
 uint8_t RS485A_Receive();
 void RS485A_EnableInterrupts();
 void RS485A_DisableInterrupts();
 //void RS485A_SendBreak(); Not yet implemented
 
+/*
+ * ISR for when a byte is received. Call from the USCIAB0RX_VECTOR ISR.
+ */
+void RS485A_Rx_ISR(void);
+
+/*
+ * ISR for when UCA0TXBUF is free. Call from the USCIAB0TX_VECTOR ISR.
+ */
+void RS485A_Tx_ISR(void);
+
 #endif
@@ -0,0 +1,143 @@
+/*
+ * @file SPIB0.c
+ * @brief Interrupt-driven SPI master on MSP430 USCI B0.
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-15
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "SPIB0.h"
+
+/// Transfer being run, followed by the rest of the queue
+static SPIB0_Xfer *SPIB0_head;
+
+/// Last transfer in the queue
+static SPIB0_Xfer *SPIB0_tail;
+
+/// Bytes of the head transfer sent so far
+static uint16_t SPIB0_index;
+
+void SPIB0_Init(uint8_t clock_source, uint16_t prescaler, uint8_t mode)
+{
+  SPIB0_head = 0;
+  UCB0CTL1 = clock_source | UCSWRST;
+  UCB0CTL0 = mode | UCMSB | UCMST | UCMODE_0 | UCSYNC;
+  UCB0BR0 = prescaler & 0xFF;
+  UCB0BR1 = prescaler >> 8;
+  UCB0CTL1 &= ~UCSWRST;
+}
+
+/*
+ * Select the head transfer's device and send its first byte.
+ */
+static void SPIB0_Begin(void)
+{
+  SPIB0_Xfer *xfer = SPIB0_head;
+
+  SPIB0_index = 0;
+  SPIB0_CS_OUT &= ~xfer->cs;
+  IE2 |= UCB0RXIE;
+  UCB0TXBUF = xfer->tx_len ? xfer->tx[0] : SPIB0_FILL;
+}
+
+void SPIB0_Queue(SPIB0_Xfer *xfer)
+{
+  uint16_t sr = __get_SR_register();
+
+  __disable_interrupt();
+  xfer->next = 0;
+  xfer->status = SPIB0_QUEUED;
+  if (SPIB0_head)
+  {
+    SPIB0_tail->next = xfer;
+  } else {
+    SPIB0_head = xfer;
+    SPIB0_Begin();
+  }
+  SPIB0_tail = xfer;
+  if (sr & GIE)
+  {
+    __enable_interrupt();
+  }
+}
+
+void SPIB0_Wait(SPIB0_Xfer *xfer)
+{
+  uint16_t sr = __get_SR_register();
+
+  __disable_interrupt();
+  while (xfer->status != SPIB0_DONE)
+  {
+    __bis_SR_register(SPIB0_LPM_BITS | GIE);
+    __disable_interrupt();
+  }
+  if (sr & GIE)
+  {
+    __enable_interrupt();
+  }
+}
+
+bool SPIB0_Busy(void)
+{
+  return SPIB0_head != 0;
+}
+
+bool SPIB0_RX_ISR(void)
+{
+  SPIB0_Xfer *xfer = SPIB0_head;
+  uint8_t data;
+
+  if (!(IFG2 & UCB0RXIFG) || !(IE2 & UCB0RXIE))
+  {
+    return false;
+  }
+  data = UCB0RXBUF;
+  if (SPIB0_index >= xfer->tx_len)
+  {
+    xfer->rx[SPIB0_index - xfer->tx_len] = data;
+  }
+  SPIB0_index++;
+  if (SPIB0_index < xfer->tx_len + xfer->rx_len)
+  {
+    UCB0TXBUF = (SPIB0_index < xfer->tx_len) ?
+        xfer->tx[SPIB0_index] : SPIB0_FILL;
+    return false;
+  }
+
+  // Done: start the next one before the callback, to keep the bus busy
+  SPIB0_CS_OUT |= xfer->cs;
+  SPIB0_head = xfer->next;
+  if (SPIB0_head)
+  {
+    SPIB0_Begin();
+  } else {
+    IE2 &= ~UCB0RXIE;
+  }
+  xfer->status = SPIB0_DONE;
+  if (xfer->callback)
+  {
+    xfer->callback(xfer);
+  }
+  return true;
+}
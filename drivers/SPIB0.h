@@ -0,0 +1,186 @@
+/*
+ * @file SPIB0.h
+ * @brief Interrupt-driven SPI master on MSP430 USCI B0.
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-15
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @details
+ * Using this Driver
+ * -----------------
+ *
+ *  Transfers are queued and run one after another from the RX interrupt, so
+ *  a long read from SPI flash goes on while the CPU sleeps. Each transfer
+ *  pulls its chip select low, sends tx_len bytes from tx, then clocks in
+ *  rx_len bytes to rx while sending SPIB0_FILL, and lets chip select go.
+ *  Bytes clocked in while sending tx are thrown away. When the transfer is
+ *  done its status becomes SPIB0_DONE and its callback is run, from the ISR.
+ *
+ *  - The SPI pins must be selected first. On the G2553: P1SEL and P1SEL2
+ *    bits 5 (CLK), 6 (SOMI) and 7 (SIMO).
+ *  - Chip select pins are bits of SPIB0_CS_OUT, set as outputs and high.
+ *  - SPIB0_Init must be called during initialization of MSP430.
+ *  - SPIB0_RX_ISR must be inserted into the USCIAB0RX_VECTOR ISR, waking the
+ *    CPU when it returns true.
+ *  - USCI B0 runs either this driver or I2CB0, not both. UARTA0 shares the
+ *    vectors, so its ISR has to check its own flag.
+ *
+ *  One byte is in flight at a time, and the next one is written from the
+ *  RX interrupt for the last. That keeps the ISR simple, and no byte comes
+ *  in before the one before it has been read. Above about SMCLK / 16 the
+ *  ISR, not the SPI clock, sets the byte rate.
+ *
+ *  Example:
+ * ~~~{.c}
+ *
+ * __attribute__((interrupt(USCIAB0RX_VECTOR)))
+ * void USCI_AB0_RX_ISR(void)
+ * {
+ * 	if ((IFG2 & UCA0RXIFG) && (IE2 & UCA0RXIE))
+ * 		UARTA0_RX_ISR();
+ * 	if (SPIB0_RX_ISR())
+ * 		_bic_SR_register_on_exit(SPIB0_LPM_BITS);
+ * }
+ *
+ * static const uint8_t read_cmd[4] = { 0x03, 0x00, 0x10, 0x00 };
+ * uint8_t page[256];
+ * SPIB0_Xfer read = {
+ * 	.tx = read_cmd, .tx_len = 4,
+ * 	.rx = page, .rx_len = 256,
+ * 	.cs = BIT4,
+ * };
+ *
+ * P1OUT |= BIT4;
+ * P1DIR |= BIT4;
+ * P1SEL |= BIT5 | BIT6 | BIT7;
+ * P1SEL2 |= BIT5 | BIT6 | BIT7;
+ * SPIB0_Init(SPIB0_SMCLK, 2, SPIB0_MODE_0);
+ * SPIB0_Queue(&read);
+ * SPIB0_Wait(&read);
+ *
+ * ~~~
+ */
+
+#ifndef _SPIB0_H_
+#define _SPIB0_H_
+
+#include <msp430.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/// Port output register the chip select pins are on
+#ifndef SPIB0_CS_OUT
+#define SPIB0_CS_OUT  P1OUT
+#endif
+
+/// Byte sent while reading
+#ifndef SPIB0_FILL
+#define SPIB0_FILL  0xFF
+#endif
+
+/// Low power mode SPIB0_Wait sleeps in. SMCLK has to keep running.
+#ifndef SPIB0_LPM_BITS
+#define SPIB0_LPM_BITS  LPM0_bits
+#endif
+
+/// @name SPI Clock Configuration Constants
+/// @{
+static const uint8_t SPIB0_ACLK  = UCSSEL_1; ///< Use ACLK as clock source
+static const uint8_t SPIB0_SMCLK = UCSSEL_2; ///< Use SMCLK as clock source
+/// @}
+
+/// @name SPI Mode Constants
+/// @{
+static const uint8_t SPIB0_MODE_0 = UCCKPH;           ///< CPOL 0, CPHA 0
+static const uint8_t SPIB0_MODE_1 = 0;                ///< CPOL 0, CPHA 1
+static const uint8_t SPIB0_MODE_2 = UCCKPL | UCCKPH;  ///< CPOL 1, CPHA 0
+static const uint8_t SPIB0_MODE_3 = UCCKPL;           ///< CPOL 1, CPHA 1
+/// @}
+
+/// @name Transfer Status
+/// @{
+#define SPIB0_QUEUED  0 ///< Waiting for or in the middle of its turn
+#define SPIB0_DONE    1 ///< Finished
+/// @}
+
+struct spib0_xfer_t {
+  struct spib0_xfer_t *next;      // Next transfer in the queue
+  const uint8_t *tx;              // Bytes to send
+  uint8_t *rx;                    // Bytes read after tx has been sent
+  uint16_t tx_len;
+  uint16_t rx_len;
+  uint8_t cs;                     // Chip select bits in SPIB0_CS_OUT, or 0
+  void (*callback)(struct spib0_xfer_t *xfer); // Run when done, or 0
+  volatile uint8_t status;        // SPIB0_QUEUED or SPIB0_DONE
+};
+
+typedef struct spib0_xfer_t SPIB0_Xfer;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Set up USCI B0 as a 3-wire SPI master, MSB first.
+ * @param clock_source SPIB0_ACLK or SPIB0_SMCLK.
+ * @param prescaler SPI clock divider, 1 or more.
+ * @param mode SPIB0_MODE_0 to SPIB0_MODE_3.
+ */
+void SPIB0_Init(uint8_t clock_source, uint16_t prescaler, uint8_t mode);
+
+/*
+ * Add a transfer to the queue, starting it if the bus is free.
+ * Safe to call from a callback.
+ * @param xfer The transfer. tx_len + rx_len must not be 0. The transfer and
+ *    its buffers must stay in scope until it is done.
+ */
+void SPIB0_Queue(SPIB0_Xfer *xfer);
+
+/*
+ * Sleep until a transfer is done. Not for use in ISRs or callbacks.
+ * Interrupts are left enabled or disabled on return, as they were on entry.
+ * Tasks can use PT_WAIT_UNTIL(pt, xfer.status == SPIB0_DONE) instead.
+ * @param xfer The transfer, already queued.
+ */
+void SPIB0_Wait(SPIB0_Xfer *xfer);
+
+/*
+ * Check if any transfers are queued or running.
+ */
+bool SPIB0_Busy(void);
+
+/*
+ * ISR for USCIAB0RX_VECTOR. Does nothing unless UCB0RXIFG is set.
+ * Reads the byte that just came in and sends the next one, or finishes the
+ * transfer and starts the next in the queue.
+ * @returns True if a transfer finished, so the CPU should wake up.
+ */
+bool SPIB0_RX_ISR(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif
@@ -0,0 +1,263 @@
+/*
+ * @file TimerA0.c
+ * @brief Software timers on MSP430 Timer0_A.
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-12
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "TimerA0.h"
+
+/// Longest compare step. Keeping it to half the counter range means a
+/// deadline that has already gone by can be told from one still to come.
+#define TIMERA0_MAX_STEP  0x8000
+
+/// Head of the timer queue
+static TimerA0_Timer *TimerA0_head;
+
+/// Counter value the head timer's delta is counted from
+static uint16_t TimerA0_ref;
+
+/// Set by the TimerA0_Delay timer
+static volatile bool TimerA0_delay_done;
+
+void TimerA0_Init(uint16_t divider)
+{
+  TimerA0_head = 0;
+  TA0CCTL0 = 0;
+  TA0CTL = TASSEL_1 | MC_2 | TACLR | divider;
+  TimerA0_ref = 0;
+}
+
+uint16_t TimerA0_Now(void)
+{
+  uint16_t a;
+  uint16_t b = TA0R;
+
+  do {
+    a = b;
+    b = TA0R;
+  } while (a != b);
+  return a;
+}
+
+//=============================================================================
+// Timer Queue
+//=============================================================================
+
+/*
+ * Move the reference up to now, taking the time off the head timer.
+ * Stops at the head's deadline, so periodic timers are rescheduled from
+ * when they were due, however late the ISR runs.
+ */
+static void TimerA0_Advance(void)
+{
+  uint16_t now = TimerA0_Now();
+  uint16_t elapsed;
+
+  if (!TimerA0_head)
+  {
+    TimerA0_ref = now;
+    return;
+  }
+  elapsed = now - TimerA0_ref;
+  if (elapsed > TimerA0_head->delta)
+  {
+    elapsed = TimerA0_head->delta;
+  }
+  TimerA0_head->delta -= elapsed;
+  TimerA0_ref += elapsed;
+}
+
+/*
+ * Put a timer into the queue.
+ * Timers due at the same time run in the order they were added.
+ * @param timer The timer.
+ * @param ticks Ticks from the reference to its deadline.
+ */
+static void TimerA0_Insert(TimerA0_Timer *timer, uint32_t ticks)
+{
+  TimerA0_Timer **p = &TimerA0_head;
+
+  while (*p && ((*p)->delta <= ticks))
+  {
+    ticks -= (*p)->delta;
+    p = &(*p)->next;
+  }
+  timer->delta = ticks;
+  timer->next = *p;
+  if (*p)
+  {
+    (*p)->delta -= ticks;
+  }
+  *p = timer;
+  timer->active = true;
+}
+
+/*
+ * Take a timer out of the queue, giving its delta to the next one.
+ * @param timer The timer, which must be in the queue.
+ */
+static void TimerA0_Remove(TimerA0_Timer *timer)
+{
+  TimerA0_Timer **p = &TimerA0_head;
+
+  while (*p != timer)
+  {
+    p = &(*p)->next;
+  }
+  *p = timer->next;
+  if (timer->next)
+  {
+    timer->next->delta += timer->delta;
+  }
+  timer->active = false;
+}
+
+/*
+ * Set CCR0 for the head of the queue, or turn the compare off if the queue
+ * is empty. Long waits are broken into steps of TIMERA0_MAX_STEP.
+ */
+static void TimerA0_Arm(void)
+{
+  uint16_t step;
+
+  if (!TimerA0_head)
+  {
+    TA0CCTL0 = 0;
+    return;
+  }
+  step = (TimerA0_head->delta > TIMERA0_MAX_STEP) ?
+      TIMERA0_MAX_STEP : TimerA0_head->delta;
+  TA0CCR0 = TimerA0_ref + step;
+  TA0CCTL0 = CCIE;
+  // A deadline that has gone by won't match until the counter wraps
+  if ((uint16_t)(TimerA0_Now() - TimerA0_ref) >= step)
+  {
+    TA0CCTL0 = CCIE | CCIFG;
+  }
+}
+
+void TimerA0_Start(
+    TimerA0_Timer *timer,
+    uint32_t ticks,
+    uint32_t period,
+    void (*callback)(TimerA0_Timer *timer))
+{
+  uint16_t sr = __get_SR_register();
+
+  __disable_interrupt();
+  if (timer->active)
+  {
+    TimerA0_Remove(timer);
+  }
+  TimerA0_Advance();
+  timer->period = period;
+  timer->callback = callback;
+  // The reference can trail now if the head timer is overdue
+  TimerA0_Insert(timer, ticks + (uint16_t)(TimerA0_Now() - TimerA0_ref));
+  TimerA0_Arm();
+  if (sr & GIE)
+  {
+    __enable_interrupt();
+  }
+}
+
+void TimerA0_Stop(TimerA0_Timer *timer)
+{
+  uint16_t sr = __get_SR_register();
+
+  __disable_interrupt();
+  if (timer->active)
+  {
+    TimerA0_Remove(timer);
+    TimerA0_Arm();
+  }
+  if (sr & GIE)
+  {
+    __enable_interrupt();
+  }
+}
+
+bool TimerA0_ISR(void)
+{
+  TimerA0_Timer *timer;
+  bool ran = false;
+
+  TimerA0_Advance();
+  while (TimerA0_head && !TimerA0_head->delta)
+  {
+    timer = TimerA0_head;
+    TimerA0_head = timer->next;
+    timer->active = false;
+    // Requeue before the callback, so the callback can stop or restart it
+    if (timer->period)
+    {
+      TimerA0_Insert(timer, timer->period);
+    }
+    timer->callback(timer);
+    ran = true;
+  }
+  TimerA0_Arm();
+  return ran;
+}
+
+//=============================================================================
+// Sleeping
+//=============================================================================
+
+void TimerA0_SleepUntil(volatile bool *flag)
+{
+  uint16_t sr = __get_SR_register();
+
+  __disable_interrupt();
+  while (!*flag)
+  {
+    __bis_SR_register(TIMERA0_LPM_BITS | GIE);
+    __disable_interrupt();
+  }
+  if (sr & GIE)
+  {
+    __enable_interrupt();
+  }
+}
+
+/*
+ * Callback for the TimerA0_Delay timer.
+ */
+static void TimerA0_DelayDone(TimerA0_Timer *timer)
+{
+  (void)timer;
+  TimerA0_delay_done = true;
+}
+
+void TimerA0_Delay(uint32_t ticks)
+{
+  TimerA0_Timer timer;
+
+  timer.active = false;
+  TimerA0_delay_done = false;
+  TimerA0_Start(&timer, ticks, 0, TimerA0_DelayDone);
+  TimerA0_SleepUntil(&TimerA0_delay_done);
+}
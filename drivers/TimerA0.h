@@ -0,0 +1,188 @@
+/*
+ * @file TimerA0.h
+ * @brief Software timers on MSP430 Timer0_A.
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-12
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @details
+ * Using this Driver
+ * -----------------
+ *
+ *  Timer0_A free-runs from ACLK in continuous mode. Active timers are kept in
+ *  a queue sorted by deadline, each holding the ticks after the one before
+ *  it, and CCR0 is set for the head of the queue only. There is no periodic
+ *  tick: the CPU is woken at the next deadline and not before. Since ACLK
+ *  keeps running in LPM3, the CPU can sleep in LPM3 between deadlines.
+ *
+ *  - ACLK must be set up first, from the 32 kHz crystal or the VLO (BCSCTL3).
+ *    Set TIMERA0_HZ to the ACLK frequency after the input divider.
+ *  - TimerA0_Init must be called during initialization of MSP430.
+ *  - TimerA0_ISR must be inserted into the TIMER0_A0_VECTOR ISR, waking the
+ *    CPU when it returns true.
+ *  - Callbacks run in the ISR, so they should be short. Setting a flag for
+ *    the main loop is the usual thing to do.
+ *
+ *  Example:
+ * ~~~{.c}
+ *
+ * volatile bool blink;
+ *
+ * void Blink(TimerA0_Timer *t)
+ * {
+ * 	blink = true;
+ * }
+ *
+ * __attribute__((interrupt(TIMER0_A0_VECTOR)))
+ * void TIMER0_A0_ISR(void)
+ * {
+ * 	if (TimerA0_ISR())
+ * 		_bic_SR_register_on_exit(TIMERA0_LPM_BITS);
+ * }
+ *
+ * TimerA0_Timer blinker;
+ * TimerA0_Start(&blinker, TIMERA0_MS(500), TIMERA0_MS(500), Blink);
+ * while (1) {
+ * 	TimerA0_SleepUntil(&blink);
+ * 	blink = false;
+ * 	P1OUT ^= BIT0;
+ * }
+ *
+ * ~~~
+ */
+
+#ifndef _TIMERA0_H_
+#define _TIMERA0_H_
+
+#include <msp430.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/// Timer tick frequency: ACLK after the input divider
+#ifndef TIMERA0_HZ
+#define TIMERA0_HZ  32768UL
+#endif
+
+/// Low power mode to sleep in. Use LPM0_bits if something clocked from
+/// SMCLK, like the UART, has to keep running while asleep.
+#ifndef TIMERA0_LPM_BITS
+#define TIMERA0_LPM_BITS  LPM3_bits
+#endif
+
+/// Convert milliseconds to timer ticks, rounding up
+#define TIMERA0_MS(ms) (((uint32_t)(ms) * TIMERA0_HZ + 999UL) / 1000UL)
+
+/// @name Timer Clock Configuration Constants
+/// @{
+static const uint16_t TIMERA0_DIV_1 = ID_0; ///< ACLK / 1
+static const uint16_t TIMERA0_DIV_2 = ID_1; ///< ACLK / 2
+static const uint16_t TIMERA0_DIV_4 = ID_2; ///< ACLK / 4
+static const uint16_t TIMERA0_DIV_8 = ID_3; ///< ACLK / 8
+/// @}
+
+struct timera0_timer_t {
+  struct timera0_timer_t *next;   // Next timer in the queue
+  uint32_t delta;                 // Ticks after the timer before it
+  uint32_t period;                // Ticks between runs, or 0 for one-shot
+  void (*callback)(struct timera0_timer_t *timer);
+  bool active;                    // In the queue
+};
+
+typedef struct timera0_timer_t TimerA0_Timer;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Start Timer0_A running from ACLK and clear the timer queue.
+ * @param divider TIMERA0_DIV_1, TIMERA0_DIV_2, TIMERA0_DIV_4, or
+ *    TIMERA0_DIV_8.
+ */
+void TimerA0_Init(uint16_t divider);
+
+/*
+ * Start a timer, or restart it if it is already running.
+ * Periodic timers are rescheduled from their deadline, not from when the
+ * callback ran, so they don't drift. Safe to call from a callback.
+ * @param timer The timer. Must stay in scope while it is running.
+ * @param ticks Ticks until the first run.
+ * @param period Ticks between later runs, or 0 to run once.
+ * @param callback Function to call from the ISR when the timer runs out.
+ */
+void TimerA0_Start(
+    TimerA0_Timer *timer,
+    uint32_t ticks,
+    uint32_t period,
+    void (*callback)(TimerA0_Timer *timer));
+
+/*
+ * Stop a timer. Does nothing if it isn't running.
+ * @param timer The timer.
+ */
+void TimerA0_Stop(TimerA0_Timer *timer);
+
+/*
+ * Read the free-running counter.
+ * ACLK is not in step with MCLK, so the count is read until two reads agree.
+ */
+uint16_t TimerA0_Now(void);
+
+/*
+ * ISR for the CCR0 compare. Runs any timers that are due and sets CCR0 for
+ * the next deadline.
+ * @returns True if any callbacks were run, so the CPU should wake up.
+ */
+bool TimerA0_ISR(void);
+
+/*
+ * Sleep until a flag is set by a callback or another ISR.
+ * Interrupts are enabled in the same instruction that enters low power mode,
+ * so a wake-up between checking the flag and sleeping is not missed. They
+ * are left enabled or disabled on return, as they were on entry.
+ * @param flag Flag to wait on.
+ */
+void TimerA0_SleepUntil(volatile bool *flag);
+
+/*
+ * Sleep for a number of ticks. A low power replacement for delay_ms.
+ * Not for use in ISRs or callbacks.
+ * @param ticks Ticks to sleep for, e.g. TIMERA0_MS(100).
+ */
+void TimerA0_Delay(uint32_t ticks);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+/*
+ * Sleep until the next interrupt.
+ */
+static inline void TimerA0_Sleep(void)
+{
+  __bis_SR_register(TIMERA0_LPM_BITS | GIE);
+}
+
+#endif
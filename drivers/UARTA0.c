@@ -28,6 +28,7 @@
  * SOFTWARE.
  */
 #include "UARTA0.h"
+#include "../clock.h"
 
 void UARTA0_EnableInterrupts() {
   IE2 |= UCA0RXIE;
@@ -40,7 +41,7 @@ void UARTA0_DisableInterrupts() {
 //=============================================================================
 // UART Transmit Function
 //=============================================================================
-void UARTA0_Send(char data)
+bool UARTA0_TrySend(char data)
 {
 	// Put straight to UART if not yet transmitting
 	if (!UARTA0_transmitting)
@@ -48,11 +49,37 @@ void UARTA0_Send(char data)
 		UCA0TXBUF = data;
 		UARTA0_transmitting = 1;
 		IE2 |= UCA0TXIE;
-	  // Load data into TX buffer
-	} else {
+		return true;
+	}
+	// Load data into TX buffer, if there's room
+	if (FIFO_Full(&UARTA0_tx_buffer))
+	{
+		return false;
+	}
+	FIFO_Put(&UARTA0_tx_buffer, data);
+	return true;
+}
+
+void UARTA0_Send(char data)
+{
+	// Loop continuously while the buffer is full
+	while (!UARTA0_TrySend(data));
+}
+
+//=============================================================================
+// UART Bulk Transmit Function
+//=============================================================================
+void UARTA0_Write(const char *data, uint8_t len)
+{
+	while (len--)
+	{
 		// Make sure the buffer isn't full. Loop continuously if it is.
-    while(FIFO_Full(&UARTA0_tx_buffer));
-    FIFO_Put(&UARTA0_tx_buffer, data);
+		while(FIFO_Full(&UARTA0_tx_buffer));
+		FIFO_Put(&UARTA0_tx_buffer, *data++);
+		// TXIFG stays set while TXBUF is empty, so enabling the interrupt
+		// starts the transfer if it had stopped.
+		UARTA0_transmitting = true;
+		IE2 |= UCA0TXIE;
 	}
 }
 
@@ -61,3 +88,46 @@ uint8_t UARTA0_Receive()
 	return FIFO_Get(&UARTA0_rx_buffer);
 }
 
+
+//=============================================================================
+// Clock Scaling
+//=============================================================================
+
+/// Baud rate to keep when the clock changes, or 0 for fixed dividers
+static uint32_t UARTA0_baud;
+
+/// Interrupt enables saved across a clock change
+static uint8_t UARTA0_saved_ie;
+
+void UARTA0_ClockNotify(uint8_t event)
+{
+  uint16_t br;
+
+  if (!UARTA0_baud)
+  {
+    return;
+  }
+  if (event == CLOCK_PRE_CHANGE)
+  {
+    // Let the byte being shifted out finish, without starting another one
+    UARTA0_saved_ie = IE2 & (UCA0RXIE | UCA0TXIE);
+    IE2 &= ~UCA0TXIE;
+    while (UCA0STAT & UCBUSY);
+    UCA0CTL1 |= UCSWRST;
+  } else {
+    UCA0MCTL = Clock_UARTDividers(Clock_cfg.smclk_hz, UARTA0_baud, &br);
+    UCA0BR0 = br & 0xFF;
+    UCA0BR1 = br >> 8;
+    UCA0CTL1 &= ~UCSWRST;
+    // Reset sets TXIFG, so a pending TX buffer starts sending again
+    IE2 |= UARTA0_saved_ie;
+  }
+}
+
+void UARTA0_SetBaud(uint32_t baud)
+{
+  UARTA0_baud = baud;
+  UARTA0_ClockNotify(CLOCK_PRE_CHANGE);
+  UCA0CTL1 = (UCA0CTL1 & ~UCSSEL_3) | UARTA0_SMCLK;
+  UARTA0_ClockNotify(CLOCK_POST_CHANGE);
+}
@@ -0,0 +1,242 @@
+/*
+ * @file BCDCheck.c
+ * @brief Host check of the BCDConv routines against a reference
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-16
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @details
+ *  Runs every routine in BCDConv.h over its full input range and compares
+ *  each result with a reference built from division and remainder. The
+ *  16-bit routines see all 65536 inputs (bin2bcd16 only 0-9999, which is all
+ *  it handles), bcd2bin16 sees every valid 4-digit BCD value, and bin2bcd32
+ *  sees the 16-bit range plus the decade edges and a spread of 32-bit
+ *  values. The first mismatch of each routine is printed, and the run fails
+ *  if there are any. Built and run by `make test` in this directory, against
+ *  BCDConv.c; the same checks hold for BCDConv.s, which it mirrors.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include "BCDConv.h"
+
+/// Spread of 32-bit values checked past the 16-bit range
+#define BCDCHECK_SAMPLES 1000000UL
+
+static unsigned BCDCheck_failed;
+
+//=============================================================================
+// Reference
+//=============================================================================
+
+/**
+ * Packed BCD of a binary value, one digit per nibble.
+ * @param bin Value to convert
+ * @returns BCD value, as many digits as needed
+ */
+static uint64_t BCDCheck_ToBCD(uint32_t bin)
+{
+  uint64_t bcd = 0;
+  unsigned shift = 0;
+
+  while (bin) {
+    bcd |= (uint64_t)(bin % 10) << shift;
+    bin /= 10;
+    shift += 4;
+  }
+  return bcd;
+}
+
+//=============================================================================
+// Reporting
+//=============================================================================
+
+/**
+ * Tallies one result, printing only the first mismatch of a routine.
+ * @param errors Mismatch count of the routine being checked
+ * @param name Routine name
+ * @param in Input given
+ * @param got Result returned
+ * @param want Reference result
+ */
+static void BCDCheck_Compare(unsigned *errors, const char *name,
+    uint32_t in, uint64_t got, uint64_t want)
+{
+  if (got == want) return;
+  if (!*errors) {
+    printf("FAIL %s(0x%lX) = 0x%llX, expected 0x%llX\n", name,
+        (unsigned long)in, (unsigned long long)got, (unsigned long long)want);
+  }
+  (*errors)++;
+}
+
+/**
+ * Prints the result line of a routine.
+ * @param errors Mismatch count of the routine
+ * @param name Routine name
+ * @param count Inputs checked
+ */
+static void BCDCheck_Report(unsigned errors, const char *name,
+    unsigned long count)
+{
+  if (errors) {
+    printf("FAIL %-20s %u of %lu values wrong\n", name, errors, count);
+    BCDCheck_failed++;
+  } else {
+    printf("ok   %-20s %lu values\n", name, count);
+  }
+}
+
+//=============================================================================
+// Checks
+//=============================================================================
+
+static void BCDCheck_Bin2BCD8(void)
+{
+  unsigned errors = 0;
+  unsigned errors_unrolled = 0;
+  uint32_t i;
+
+  for (i = 0; i <= 0xFF; i++) {
+    BCDCheck_Compare(&errors, "bin2bcd8", i,
+        bin2bcd8(i), BCDCheck_ToBCD(i));
+    BCDCheck_Compare(&errors_unrolled, "bin2bcd8_unrolled", i,
+        bin2bcd8_unrolled(i), BCDCheck_ToBCD(i));
+  }
+  BCDCheck_Report(errors, "bin2bcd8", 0x100);
+  BCDCheck_Report(errors_unrolled, "bin2bcd8_unrolled", 0x100);
+}
+
+static void BCDCheck_Bin2BCD16(void)
+{
+  unsigned errors = 0;
+  unsigned errors_unrolled = 0;
+  uint32_t i;
+
+  for (i = 0; i <= 9999; i++) {
+    BCDCheck_Compare(&errors, "bin2bcd16", i,
+        bin2bcd16(i), BCDCheck_ToBCD(i));
+    BCDCheck_Compare(&errors_unrolled, "bin2bcd16_unrolled", i,
+        bin2bcd16_unrolled(i), BCDCheck_ToBCD(i));
+  }
+  BCDCheck_Report(errors, "bin2bcd16", 10000);
+  BCDCheck_Report(errors_unrolled, "bin2bcd16_unrolled", 10000);
+}
+
+static void BCDCheck_Bin2BCD16l(void)
+{
+  unsigned errors = 0;
+  uint32_t i;
+
+  for (i = 0; i <= 0xFFFF; i++) {
+    BCDCheck_Compare(&errors, "bin2bcd16l", i,
+        bin2bcd16l(i), BCDCheck_ToBCD(i));
+  }
+  BCDCheck_Report(errors, "bin2bcd16l", 0x10000);
+}
+
+static void BCDCheck_Bin2BCD32(void)
+{
+  unsigned errors = 0;
+  unsigned long count = 0;
+  uint32_t decade;
+  uint32_t x;
+  uint32_t i;
+
+  // Whole 16-bit range
+  for (i = 0; i <= 0xFFFF; i++, count++) {
+    BCDCheck_Compare(&errors, "bin2bcd32", i,
+        bin2bcd32(i), BCDCheck_ToBCD(i));
+  }
+
+  // Either side of each power of ten, where a digit is added
+  for (decade = 10; decade <= 1000000000UL; decade *= 10) {
+    for (x = decade - 2; x != decade + 2; x++, count++) {
+      BCDCheck_Compare(&errors, "bin2bcd32", x,
+          bin2bcd32(x), BCDCheck_ToBCD(x));
+    }
+  }
+  x = 0xFFFFFFFFUL;
+  BCDCheck_Compare(&errors, "bin2bcd32", x, bin2bcd32(x), BCDCheck_ToBCD(x));
+  count++;
+
+  // Spread over the rest, from a fixed LCG so runs repeat
+  x = 1;
+  for (i = 0; i < BCDCHECK_SAMPLES; i++, count++) {
+    x = x * 1664525UL + 1013904223UL;
+    BCDCheck_Compare(&errors, "bin2bcd32", x,
+        bin2bcd32(x), BCDCheck_ToBCD(x));
+  }
+  BCDCheck_Report(errors, "bin2bcd32", count);
+}
+
+static void BCDCheck_BCD2Bin8(void)
+{
+  unsigned errors = 0;
+  uint32_t i;
+
+  for (i = 0; i <= 99; i++) {
+    BCDCheck_Compare(&errors, "bcd2bin8", BCDCheck_ToBCD(i),
+        bcd2bin8(BCDCheck_ToBCD(i)), i);
+  }
+  BCDCheck_Report(errors, "bcd2bin8", 100);
+}
+
+static void BCDCheck_BCD2Bin16(void)
+{
+  unsigned errors = 0;
+  unsigned errors_trip = 0;
+  uint32_t i;
+
+  for (i = 0; i <= 9999; i++) {
+    BCDCheck_Compare(&errors, "bcd2bin16", BCDCheck_ToBCD(i),
+        bcd2bin16(BCDCheck_ToBCD(i)), i);
+    BCDCheck_Compare(&errors_trip, "bcd2bin16(bin2bcd16)", i,
+        bcd2bin16(bin2bcd16(i)), i);
+  }
+  BCDCheck_Report(errors, "bcd2bin16", 10000);
+  BCDCheck_Report(errors_trip, "bcd2bin16(bin2bcd16)", 10000);
+}
+
+//=============================================================================
+// Main
+//=============================================================================
+
+int main(void)
+{
+  BCDCheck_Bin2BCD8();
+  BCDCheck_Bin2BCD16();
+  BCDCheck_Bin2BCD16l();
+  BCDCheck_Bin2BCD32();
+  BCDCheck_BCD2Bin8();
+  BCDCheck_BCD2Bin16();
+
+  if (BCDCheck_failed) {
+    printf("%u routine(s) failed\n", BCDCheck_failed);
+    return 1;
+  }
+  printf("all BCD conversions match\n");
+  return 0;
+}
@@ -0,0 +1,331 @@
+/*
+ * @file CycleBench.c
+ * @brief Cycle counts of the hot paths on the MSP430 simulator
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-16
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @details
+ *  Target code, not a host program: cycles.sh cross-compiles it with
+ *  msp430-elf-gcc together with BCDConv.s, Format.c, FIFO.c, and the
+ *  drivers, runs it in mspdebug's simulator, and prints the table it leaves
+ *  in CycleBench_cycles. Run it with `make cycles` in this directory.
+ *
+ *  Each case is timed CYCLEBENCH_REPS times on Timer1_A from SMCLK, the way
+ *  Profile.h times its probes, with its setup run first and outside the
+ *  count. Calling an empty case is timed the same way and taken off, so a
+ *  result is what the case body costs: moving the arguments, the call, and
+ *  the routine up to its ret. ISR bodies are called as functions, so the 6
+ *  cycles to take the interrupt and the 5 for reti come on top.
+ *
+ *  cycles.sh names the results from the strings in CycleBench_cases, so
+ *  keep one case per line there.
+ */
+
+#include <msp430.h>
+#include <stdint.h>
+#include "BCDConv.h"
+#include "Format.h"
+#include "FIFO.h"
+#include "utils.h"
+#include "drivers/UARTA0.h"
+#include "drivers/RS485A.h"
+#include "drivers/ADC10.h"
+#include "drivers/TimerA0.h"
+
+/// Times each case is run. The table keeps the fewest and most cycles.
+#define CYCLEBENCH_REPS 4
+
+/// Counter the cases are timed with. Timer1_A, since TimerA0.c has Timer0_A.
+#define CYCLEBENCH_TAR   TA1R
+#define CYCLEBENCH_TACTL TA1CTL
+
+/// A timed case
+struct cyclebench_case_t {
+  const char *name;
+  void (*setup)(void);            // Puts things in the state being timed
+  void (*run)(void);              // The part that is counted
+};
+
+typedef struct cyclebench_case_t CycleBench_Case;
+
+static FIFO_Buffer CycleBench_fifo;
+static volatile uint8_t CycleBench_fifo_data[16];
+static TimerA0_Timer CycleBench_timer;
+static char CycleBench_text[16];
+
+//=============================================================================
+// Setups
+//=============================================================================
+
+static void CycleBench_FIFOEmpty(void)
+{
+  FIFO_Init(&CycleBench_fifo, CycleBench_fifo_data,
+      sizeof(CycleBench_fifo_data));
+}
+
+static void CycleBench_FIFOOne(void)
+{
+  CycleBench_FIFOEmpty();
+  FIFO_Put(&CycleBench_fifo, 'x');
+}
+
+static void CycleBench_FIFOFull(void)
+{
+  CycleBench_FIFOEmpty();
+  while (FIFO_Put(&CycleBench_fifo, 'x'));
+}
+
+static void CycleBench_UARTQueued(void)
+{
+  FIFO_Init(&UARTA0_tx_buffer, tx_buffer, UARTA0_TX_BUFFER_SIZE);
+  FIFO_Put(&UARTA0_tx_buffer, 'x');
+}
+
+static void CycleBench_UARTIdle(void)
+{
+  FIFO_Init(&UARTA0_tx_buffer, tx_buffer, UARTA0_TX_BUFFER_SIZE);
+  FIFO_Init(&UARTA0_rx_buffer, rx_buffer, UARTA0_RX_BUFFER_SIZE);
+}
+
+static void CycleBench_RS485Queued(void)
+{
+  FIFO_Put(&RS485A_tx_buffer, 'x');
+}
+
+static void CycleBench_Callback(TimerA0_Timer *timer)
+{
+  (void)timer;
+}
+
+static void CycleBench_TimerDue(void)
+{
+  TimerA0_Start(&CycleBench_timer, 0, 0, CycleBench_Callback);
+}
+
+//=============================================================================
+// Cases
+//=============================================================================
+
+static void CycleBench_Nothing(void)
+{
+}
+
+static void CycleBench_Bin2BCD8(void)
+{
+  bin2bcd8(255);
+}
+
+static void CycleBench_Bin2BCD8Unrolled(void)
+{
+  bin2bcd8_unrolled(255);
+}
+
+static void CycleBench_Bin2BCD16(void)
+{
+  bin2bcd16(9999);
+}
+
+static void CycleBench_Bin2BCD16Unrolled(void)
+{
+  bin2bcd16_unrolled(9999);
+}
+
+static void CycleBench_Bin2BCD16l(void)
+{
+  bin2bcd16l(65535);
+}
+
+static void CycleBench_Bin2BCD32(void)
+{
+  bin2bcd32(4294967295UL);
+}
+
+static void CycleBench_BCD2Bin8(void)
+{
+  bcd2bin8(0x99);
+}
+
+static void CycleBench_BCD2Bin16(void)
+{
+  bcd2bin16(0x9999);
+}
+
+static void CycleBench_FmtU16(void)
+{
+  Fmt_U16(CycleBench_text, 65535, 0, FMT_PAD_SPACE);
+}
+
+static void CycleBench_FmtS32(void)
+{
+  Fmt_S32(CycleBench_text, INT32_MIN, 0, FMT_PAD_SPACE);
+}
+
+static void CycleBench_FmtFixed16(void)
+{
+  Fmt_Fixed16(CycleBench_text, -1234, 2, 8, FMT_PAD_ZERO);
+}
+
+static void CycleBench_FIFOPut(void)
+{
+  FIFO_Put(&CycleBench_fifo, 'x');
+}
+
+static void CycleBench_FIFOGet(void)
+{
+  FIFO_Get(&CycleBench_fifo);
+}
+
+static void CycleBench_Delay10(void)
+{
+  DelayCycles(10);
+}
+
+static void CycleBench_Delay100(void)
+{
+  DelayCycles(100);
+}
+
+static void CycleBench_UARTA0TX(void)
+{
+  UARTA0_TX_ISR();
+}
+
+static void CycleBench_UARTA0RX(void)
+{
+  UARTA0_RX_ISR();
+}
+
+static void CycleBench_RS485ATX(void)
+{
+  RS485A_Tx_ISR();
+}
+
+static void CycleBench_RS485ARX(void)
+{
+  RS485A_Rx_ISR();
+}
+
+static void CycleBench_ADC10(void)
+{
+  ADC10_ISR();
+}
+
+static void CycleBench_TimerA0(void)
+{
+  TimerA0_ISR();
+}
+
+static const CycleBench_Case CycleBench_cases[] = {
+  { "bin2bcd8", 0, CycleBench_Bin2BCD8 },
+  { "bin2bcd8_unrolled", 0, CycleBench_Bin2BCD8Unrolled },
+  { "bin2bcd16", 0, CycleBench_Bin2BCD16 },
+  { "bin2bcd16_unrolled", 0, CycleBench_Bin2BCD16Unrolled },
+  { "bin2bcd16l", 0, CycleBench_Bin2BCD16l },
+  { "bin2bcd32", 0, CycleBench_Bin2BCD32 },
+  { "bcd2bin8", 0, CycleBench_BCD2Bin8 },
+  { "bcd2bin16", 0, CycleBench_BCD2Bin16 },
+  { "Fmt_U16", 0, CycleBench_FmtU16 },
+  { "Fmt_S32", 0, CycleBench_FmtS32 },
+  { "Fmt_Fixed16", 0, CycleBench_FmtFixed16 },
+  { "FIFO_Put", CycleBench_FIFOEmpty, CycleBench_FIFOPut },
+  { "FIFO_Put-full", CycleBench_FIFOFull, CycleBench_FIFOPut },
+  { "FIFO_Get", CycleBench_FIFOOne, CycleBench_FIFOGet },
+  { "FIFO_Get-empty", CycleBench_FIFOEmpty, CycleBench_FIFOGet },
+  { "DelayCycles-10", 0, CycleBench_Delay10 },
+  { "DelayCycles-100", 0, CycleBench_Delay100 },
+  { "UARTA0_TX_ISR", CycleBench_UARTQueued, CycleBench_UARTA0TX },
+  { "UARTA0_TX_ISR-last", CycleBench_UARTIdle, CycleBench_UARTA0TX },
+  { "UARTA0_RX_ISR", CycleBench_UARTIdle, CycleBench_UARTA0RX },
+  { "RS485A_Tx_ISR", CycleBench_RS485Queued, CycleBench_RS485ATX },
+  { "RS485A_Rx_ISR", 0, CycleBench_RS485ARX },
+  { "ADC10_ISR", 0, CycleBench_ADC10 },
+  { "TimerA0_ISR-idle", 0, CycleBench_TimerA0 },
+  { "TimerA0_ISR-due", CycleBench_TimerDue, CycleBench_TimerA0 },
+};
+
+#define CYCLEBENCH_CASES (sizeof(CycleBench_cases) / sizeof(CycleBench_cases[0]))
+
+/// Fewest and most cycles of each case, read back by cycles.sh
+uint16_t CycleBench_cycles[CYCLEBENCH_CASES][2];
+
+//=============================================================================
+// Timing
+//=============================================================================
+
+/**
+ * Time one run of a case.
+ * @param setup Function to run first, outside the count, or 0
+ * @param run Function to time
+ * @returns Cycles from reading the counter before the call to reading it
+ *    after
+ */
+static uint16_t CycleBench_Time(void (*setup)(void), void (*run)(void))
+{
+  uint16_t start;
+
+  if (setup) setup();
+  start = CYCLEBENCH_TAR;
+  run();
+  return CYCLEBENCH_TAR - start;
+}
+
+/**
+ * Marks the end of the run. cycles.sh stops the simulator here.
+ */
+void __attribute__((noinline)) CycleBench_Done(void)
+{
+  __asm__ __volatile__ ("nop");
+}
+
+int main(void)
+{
+  const CycleBench_Case *c;
+  uint16_t overhead;
+  uint16_t cycles;
+  uint8_t i;
+  uint8_t rep;
+
+  WDTCTL = WDTPW | WDTHOLD;
+  CYCLEBENCH_TACTL = TASSEL_2 | MC_2 | TACLR;
+  RS485A_Init(RS485A_SMCLK, 104, 0, 0, UCBRS0, 0, 0, 0);
+  TimerA0_Init(TIMERA0_DIV_1);
+  CycleBench_UARTIdle();
+
+  overhead = CycleBench_Time(0, CycleBench_Nothing);
+  for (i = 0; i < CYCLEBENCH_CASES; i++) {
+    c = &CycleBench_cases[i];
+    CycleBench_cycles[i][0] = 0xFFFF;
+    CycleBench_cycles[i][1] = 0;
+    for (rep = 0; rep < CYCLEBENCH_REPS; rep++) {
+      cycles = CycleBench_Time(c->setup, c->run) - overhead;
+      if (cycles < CycleBench_cycles[i][0]) CycleBench_cycles[i][0] = cycles;
+      if (cycles > CycleBench_cycles[i][1]) CycleBench_cycles[i][1] = cycles;
+    }
+  }
+
+  CycleBench_Done();
+  for (;;);
+}
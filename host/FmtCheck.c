@@ -0,0 +1,318 @@
+/*
+ * @file FmtCheck.c
+ * @brief Host check of the Format routines against printf
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-16
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @details
+ *  Runs every routine in Format.h over its inputs, at every number of
+ *  decimals the fixed-point routines take. The 8 and 16-bit routines see
+ *  all their inputs. The 32-bit ones see -32768 to 65535, both sides of each
+ *  power of ten, the ends of their range including INT32_MIN, and a spread
+ *  of other values. All but the bulk of the sweep are also run at every
+ *  field width from none to wider than the longest result, with both
+ *  padding characters, so widths too narrow for the value are covered too.
+ *  Each result is compared with one built with printf, along with the
+ *  length returned, and guard bytes either side of the output are checked
+ *  for writes outside it. The first mismatch of each routine is printed,
+ *  and the run fails if there are any. Built and run by `make test` in this
+ *  directory, against BCDConv.c.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "Format.h"
+
+/// Spread of values checked past the 16-bit range
+#define FMTCHECK_SAMPLES 1000UL
+
+/// Values of the range sweep nearer 0 than this get every width and padding
+#define FMTCHECK_PADDED 200
+
+/// Written around the buffer before each call, to catch writes outside it
+#define FMTCHECK_GUARD 0x7F
+
+/// Longest result: 10 digits, the sign, and the point
+#define FMTCHECK_LONGEST 12
+
+/// A Format.h routine, called with a value it takes
+typedef uint8_t (*FmtCheck_Func)(char *buf, int64_t val, uint8_t decimals,
+    uint8_t width, char pad);
+
+/// A routine to check, and the values and decimals it takes
+struct fmtcheck_routine_t {
+  const char *name;
+  FmtCheck_Func fmt;
+  int64_t min;
+  int64_t max;
+  uint8_t decimals;               // Most digits after the point
+};
+
+typedef struct fmtcheck_routine_t FmtCheck_Routine;
+
+static unsigned FmtCheck_failed;
+
+//=============================================================================
+// Routines
+//=============================================================================
+
+static uint8_t FmtCheck_U8(char *buf, int64_t val, uint8_t decimals,
+    uint8_t width, char pad)
+{
+  (void)decimals;
+  return Fmt_U8(buf, (uint8_t)val, width, pad);
+}
+
+static uint8_t FmtCheck_S8(char *buf, int64_t val, uint8_t decimals,
+    uint8_t width, char pad)
+{
+  (void)decimals;
+  return Fmt_S8(buf, (int8_t)val, width, pad);
+}
+
+static uint8_t FmtCheck_U16(char *buf, int64_t val, uint8_t decimals,
+    uint8_t width, char pad)
+{
+  (void)decimals;
+  return Fmt_U16(buf, (uint16_t)val, width, pad);
+}
+
+static uint8_t FmtCheck_S16(char *buf, int64_t val, uint8_t decimals,
+    uint8_t width, char pad)
+{
+  (void)decimals;
+  return Fmt_S16(buf, (int16_t)val, width, pad);
+}
+
+static uint8_t FmtCheck_U32(char *buf, int64_t val, uint8_t decimals,
+    uint8_t width, char pad)
+{
+  (void)decimals;
+  return Fmt_U32(buf, (uint32_t)val, width, pad);
+}
+
+static uint8_t FmtCheck_S32(char *buf, int64_t val, uint8_t decimals,
+    uint8_t width, char pad)
+{
+  (void)decimals;
+  return Fmt_S32(buf, (int32_t)val, width, pad);
+}
+
+static uint8_t FmtCheck_Fixed16(char *buf, int64_t val, uint8_t decimals,
+    uint8_t width, char pad)
+{
+  return Fmt_Fixed16(buf, (int16_t)val, decimals, width, pad);
+}
+
+static uint8_t FmtCheck_Fixed32(char *buf, int64_t val, uint8_t decimals,
+    uint8_t width, char pad)
+{
+  return Fmt_Fixed32(buf, (int32_t)val, decimals, width, pad);
+}
+
+static const FmtCheck_Routine FmtCheck_routines[] = {
+  { "Fmt_U8", FmtCheck_U8, 0, UINT8_MAX, 0 },
+  { "Fmt_S8", FmtCheck_S8, INT8_MIN, INT8_MAX, 0 },
+  { "Fmt_U16", FmtCheck_U16, 0, UINT16_MAX, 0 },
+  { "Fmt_S16", FmtCheck_S16, INT16_MIN, INT16_MAX, 0 },
+  { "Fmt_U32", FmtCheck_U32, 0, UINT32_MAX, 0 },
+  { "Fmt_S32", FmtCheck_S32, INT32_MIN, INT32_MAX, 0 },
+  { "Fmt_Fixed16", FmtCheck_Fixed16, INT16_MIN, INT16_MAX, 4 },
+  { "Fmt_Fixed32", FmtCheck_Fixed32, INT32_MIN, INT32_MAX, 9 },
+};
+
+#define FMTCHECK_ROUTINES \
+  (sizeof(FmtCheck_routines) / sizeof(FmtCheck_routines[0]))
+
+//=============================================================================
+// Reference
+//=============================================================================
+
+/**
+ * Formats a value the way Format.h describes, with printf.
+ * @param buf Output buffer
+ * @param val Value, in units of 10^-decimals
+ * @param decimals Digits after the point
+ * @param width Minimum field width
+ * @param pad FMT_PAD_SPACE or FMT_PAD_ZERO
+ */
+static void FmtCheck_Ref(char *buf, int64_t val, uint8_t decimals,
+    uint8_t width, char pad)
+{
+  unsigned long long mag = (val < 0) ? -val : val;
+  unsigned long long scale = 1;
+  char digits[32];
+  int len;
+  uint8_t i;
+
+  for (i = 0; i < decimals; i++) {
+    scale *= 10;
+  }
+  if (decimals) {
+    len = snprintf(digits, sizeof(digits), "%llu.%0*llu", mag / scale,
+        (int)decimals, mag % scale);
+  } else {
+    len = snprintf(digits, sizeof(digits), "%llu", mag);
+  }
+  len += (val < 0);
+
+  // Zeros go between the sign and digits, spaces before
+  if ((val < 0) && (pad == FMT_PAD_ZERO)) {
+    *buf++ = '-';
+  }
+  for (; len < width; len++) {
+    *buf++ = pad;
+  }
+  if ((val < 0) && (pad != FMT_PAD_ZERO)) {
+    *buf++ = '-';
+  }
+  strcpy(buf, digits);
+}
+
+//=============================================================================
+// Checks
+//=============================================================================
+
+/**
+ * Checks one value at every number of decimals, printing only the first
+ * mismatch of a routine.
+ * @param errors Mismatch count of the routine being checked
+ * @param count Results checked so far
+ * @param r The routine
+ * @param val Value to format
+ * @param padded Check every width and padding, not just width 0
+ */
+static void FmtCheck_Value(unsigned *errors, unsigned long *count,
+    const FmtCheck_Routine *r, int64_t val, bool padded)
+{
+  static const char pads[] = { FMT_PAD_SPACE, FMT_PAD_ZERO };
+  char area[FMTCHECK_LONGEST + 8];
+  char *got = area + 1;
+  char want[sizeof(area)];
+  uint8_t widths = padded ? FMTCHECK_LONGEST + 2 : 0;
+  uint8_t decimals;
+  uint8_t width;
+  uint8_t len;
+  uint8_t p;
+
+  for (decimals = 0; decimals <= r->decimals; decimals++) {
+    for (width = 0; width <= widths; width++) {
+      for (p = 0; p < (padded ? sizeof(pads) : 1); p++, (*count)++) {
+        memset(area, FMTCHECK_GUARD, sizeof(area));
+        len = r->fmt(got, val, decimals, width, pads[p]);
+        FmtCheck_Ref(want, val, decimals, width, pads[p]);
+        if ((len == strlen(want)) && !strcmp(got, want)
+            && (area[0] == FMTCHECK_GUARD)
+            && (got[len + 1] == FMTCHECK_GUARD)) {
+          continue;
+        }
+        if (!*errors) {
+          printf("FAIL %s(%lld, decimals %u, width %u, '%c') = \"%.*s\" "
+              "(%u), expected \"%s\"\n", r->name, (long long)val, decimals,
+              width, pads[p], (int)sizeof(area) - 1, got, len, want);
+        }
+        (*errors)++;
+      }
+    }
+  }
+}
+
+/**
+ * Checks a routine over its inputs and prints its result line.
+ * @param r The routine
+ */
+static void FmtCheck_Run(const FmtCheck_Routine *r)
+{
+  unsigned errors = 0;
+  unsigned long count = 0;
+  uint64_t span = r->max - r->min + 1;
+  int64_t lo = (r->min < INT16_MIN) ? INT16_MIN : r->min;
+  int64_t hi = (r->max > UINT16_MAX) ? UINT16_MAX : r->max;
+  int64_t decade;
+  int64_t x;
+  uint32_t seed;
+  uint32_t i;
+
+  // Whole range, or -32768 to 65535 of the 32-bit routines
+  for (x = lo; x <= hi; x++) {
+    FmtCheck_Value(&errors, &count, r, x,
+        (x > -FMTCHECK_PADDED) && (x < FMTCHECK_PADDED));
+  }
+
+  if (span > 0x10000) {
+    // Either side of each power of ten, where a digit is added
+    for (decade = 10; decade <= 1000000000; decade *= 10) {
+      for (x = decade - 2; x <= decade + 2; x++) {
+        if (x <= r->max) {
+          FmtCheck_Value(&errors, &count, r, x, true);
+        }
+        if (-x >= r->min) {
+          FmtCheck_Value(&errors, &count, r, -x, true);
+        }
+      }
+    }
+    for (x = 0; x < 2; x++) {
+      FmtCheck_Value(&errors, &count, r, r->min + x, true);
+      FmtCheck_Value(&errors, &count, r, r->max - x, true);
+    }
+
+    // Spread over the rest, from a fixed LCG so runs repeat
+    seed = 1;
+    for (i = 0; i < FMTCHECK_SAMPLES; i++) {
+      seed = seed * 1664525UL + 1013904223UL;
+      FmtCheck_Value(&errors, &count, r, r->min + seed % span, true);
+    }
+  }
+
+  if (errors) {
+    printf("FAIL %-12s %u of %lu results wrong\n", r->name, errors, count);
+    FmtCheck_failed++;
+  } else {
+    printf("ok   %-12s %lu results\n", r->name, count);
+  }
+}
+
+//=============================================================================
+// Main
+//=============================================================================
+
+int main(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < FMTCHECK_ROUTINES; i++) {
+    FmtCheck_Run(&FmtCheck_routines[i]);
+  }
+
+  if (FmtCheck_failed) {
+    printf("%u routine(s) failed\n", FmtCheck_failed);
+    return 1;
+  }
+  printf("all formats match\n");
+  return 0;
+}
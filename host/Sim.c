@@ -0,0 +1,1060 @@
+/*
+ * @file Sim.c
+ * @brief Host peripheral models for MSP430G2xx drivers
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-16
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/time.h>
+#include "msp430.h"
+#include "Sim.h"
+
+/// Host time between SIGALRM ticks, in microseconds
+#define SIM_ALARM_US 50
+
+/// Simulated cycles each SIGALRM tick lets pass
+#define SIM_ALARM_CYCLES 1024
+
+/// DCO frequency with no calibration loaded
+#define SIM_DCO_DEFAULT_HZ 1100000UL
+
+/// Calibrated DCO frequencies, in CAL_DCO_* order
+static const uint32_t Sim_dco_hz[4] = {
+  16000000UL, 12000000UL, 8000000UL, 1000000UL,
+};
+
+/// DCOCTL and BCSCTL1 calibration values, in CAL_DCO_* order
+static const uint8_t Sim_dco_cal[8] = {
+  0x95, 0x8F, 0x9E, 0x8E, 0x8B, 0x8D, 0xD1, 0x86,
+};
+
+/// Temperature sensor readings at 30 and 85 C with the 1.5 V reference
+#define SIM_ADC_15T30 745
+#define SIM_ADC_15T85 878
+
+/// @name I2C bus states
+/// @{
+#define SIM_I2C_IDLE  0               // Bus free
+#define SIM_I2C_ADDR  1               // START and address going out
+#define SIM_I2C_TX    2               // Data byte going out
+#define SIM_I2C_RX    3               // Data byte coming in
+#define SIM_I2C_HOLD  4               // SCL held low, waiting for the CPU
+#define SIM_I2C_STOP  5               // STOP going out
+/// @}
+
+/// ADC10 sample-and-hold times, in ADC10CLK cycles, by ADC10SHTx
+static const uint8_t Sim_adc_sht[4] = { 4, 8, 16, 64 };
+
+volatile Sim_Regs Sim_regs;
+Sim_Stats Sim_stats;
+uint16_t Sim_tlv[32];
+
+/// Samples returned by one ADC10 channel
+struct sim_adc_channel_t {
+  uint16_t *samples;
+  uint32_t count;
+  uint32_t next;
+};
+
+/// Model state that isn't in a register
+static struct {
+  volatile uint16_t sr;           // Status register
+  volatile uint16_t *isr_sr;      // SR to restore when the ISR returns
+  volatile sig_atomic_t depth;    // Calls into the models in progress
+  volatile sig_atomic_t accessed; // Register accessed since the last alarm
+  bool ticking;                   // In Sim_Advance
+  bool dispatching;               // Taking an interrupt
+  uint32_t mclk_hz;
+  uint32_t smclk_hz;
+  uint32_t aclk_hz;
+
+  void (*vectors[SIM_VECTORS])(void);
+  void (*tx)(uint8_t byte);
+
+  bool a0_reset;                  // UCSWRST was set on the last tick
+  int16_t a0_shift;               // Byte being shifted out, or -1
+  uint64_t a0_tx_done;            // Cycle the shift finishes on
+  uint64_t a0_rx_next;            // Cycle the next byte arrives on
+  uint8_t rx_queue[SIM_RX_QUEUE];
+  uint16_t rx_head;
+  uint16_t rx_count;
+
+  uint8_t (*spi)(uint8_t byte);
+  uint8_t i2c_address;
+  void (*i2c_start)(bool read);
+  bool (*i2c_write)(uint8_t byte);
+  uint8_t (*i2c_read)(void);
+
+  bool b0_reset;                  // UCSWRST was set on the last tick
+  int16_t b0_shift;               // Byte being shifted out, or -1
+  uint64_t b0_done;               // Cycle the bus action finishes on
+  uint8_t b0_i2c;                 // SIM_I2C_* bus state
+  bool b0_read;                   // I2C master is receiving
+  bool b0_nacked;                 // I2C device didn't acknowledge
+
+  bool adc_busy;
+  uint64_t adc_done;              // Cycle the conversion finishes on
+  uint8_t adc_block;              // Samples written by the DTC
+  struct sim_adc_channel_t adc[16];
+
+  uint64_t ta_acc[2];             // Timer clock remainder, in Hz * cycles
+} Sim;
+
+//=============================================================================
+// Basic Clock
+//=============================================================================
+
+/**
+ * Work out MCLK, SMCLK, and ACLK from the clock registers.
+ */
+static void Sim_Clocks(void)
+{
+  uint32_t dco = SIM_DCO_DEFAULT_HZ;
+  uint8_t i;
+
+  for (i = 0; i < 4; i++)
+  {
+    if ((Sim_regs.dcoctl == Sim_dco_cal[2 * i])
+        && ((Sim_regs.bcsctl1 & 0x0F) == (Sim_dco_cal[2 * i + 1] & 0x0F)))
+    {
+      dco = Sim_dco_hz[i];
+      break;
+    }
+  }
+  Sim.mclk_hz = dco >> ((Sim_regs.bcsctl2 & DIVM_3) >> 4);
+  Sim.smclk_hz = dco >> ((Sim_regs.bcsctl2 & DIVS_3) >> 1);
+  Sim.aclk_hz = (((Sim_regs.bcsctl3 & LFXT1S_3) == LFXT1S_2) ? 12000 : 32768)
+    >> ((Sim_regs.bcsctl1 & DIVA_3) >> 4);
+  Sim_stats.mclk_hz = Sim.mclk_hz;
+}
+
+/**
+ * Convert a number of cycles of some clock to MCLK cycles.
+ * @param n Cycles of the other clock.
+ * @param hz Frequency of the other clock.
+ */
+static uint64_t Sim_ToMCLK(uint64_t n, uint32_t hz)
+{
+  return (n * Sim.mclk_hz + hz - 1) / hz;
+}
+
+//=============================================================================
+// USCI_A0 UART
+//=============================================================================
+
+/**
+ * MCLK cycles to send or receive one character at the current settings.
+ */
+static uint64_t Sim_UARTByteCycles(void)
+{
+  uint16_t br = Sim_regs.uca0br0 | (Sim_regs.uca0br1 << 8);
+  uint8_t mctl = Sim_regs.uca0mctl;
+  uint32_t brclk;
+  uint32_t bit16;                 // BRCLK cycles per bit, times 16
+  uint8_t bits = 10;
+
+  brclk = ((Sim_regs.uca0ctl1 & UCSSEL_3) == UCSSEL_1) ?
+      Sim.aclk_hz : Sim.smclk_hz;
+  if (!br)
+  {
+    br = 1;
+  }
+  if (mctl & UCOS16)
+  {
+    bit16 = ((uint32_t)br << 8) + (mctl & 0xF0);
+  } else {
+    bit16 = ((uint32_t)br << 4) + ((mctl & 0x0E) << 1);
+  }
+  if (Sim_regs.uca0ctl0 & UCPEN)
+  {
+    bits++;
+  }
+  if (Sim_regs.uca0ctl0 & UCSPB)
+  {
+    bits++;
+  }
+  if (Sim_regs.uca0ctl0 & UC7BIT)
+  {
+    bits--;
+  }
+  return Sim_ToMCLK((uint64_t)bits * bit16, brclk * 16);
+}
+
+/**
+ * Step the UART: move written bytes into the shift register, finish
+ * shifting, and deliver received bytes.
+ */
+static void Sim_UART(void)
+{
+  uint64_t now = Sim_stats.cycles;
+
+  if (Sim_regs.uca0ctl1 & UCSWRST)
+  {
+    if (!Sim.a0_reset)
+    {
+      Sim_regs.ie2 &= ~(UCA0RXIE | UCA0TXIE);
+      Sim.a0_reset = true;
+    }
+    Sim_regs.ifg2 = (Sim_regs.ifg2 & ~UCA0RXIFG) | UCA0TXIFG;
+    Sim_regs.uca0stat = 0;
+    Sim_regs.uca0txbuf = SIM_TXBUF_EMPTY;
+    Sim.a0_shift = -1;
+    return;
+  }
+  if (Sim.a0_reset)
+  {
+    Sim.a0_reset = false;
+    Sim.a0_rx_next = now + Sim_UARTByteCycles();
+  }
+
+  // Transmit
+  if ((Sim.a0_shift >= 0) && (now >= Sim.a0_tx_done))
+  {
+    if (Sim.tx)
+    {
+      Sim.tx((uint8_t)Sim.a0_shift);
+    }
+    Sim_stats.tx_bytes++;
+    Sim.a0_shift = -1;
+  }
+  if (Sim_regs.uca0txbuf != SIM_TXBUF_EMPTY)
+  {
+    if (Sim.a0_shift < 0)
+    {
+      Sim.a0_shift = Sim_regs.uca0txbuf & 0xFF;
+      Sim.a0_tx_done = now + Sim_UARTByteCycles();
+      Sim_regs.uca0txbuf = SIM_TXBUF_EMPTY;
+      Sim_regs.ifg2 |= UCA0TXIFG;
+    } else {
+      Sim_regs.ifg2 &= ~UCA0TXIFG;
+    }
+  }
+  if (Sim.a0_shift >= 0)
+  {
+    Sim_regs.uca0stat |= UCBUSY;
+  } else {
+    Sim_regs.uca0stat &= ~UCBUSY;
+  }
+
+  // Receive
+  if (Sim.rx_count && (now >= Sim.a0_rx_next))
+  {
+    if (Sim_regs.ifg2 & UCA0RXIFG)
+    {
+      Sim_regs.uca0stat |= UCOE;
+      Sim_stats.rx_overruns++;
+    }
+    Sim_regs.uca0rxbuf = Sim.rx_queue[Sim.rx_head];
+    Sim.rx_head = (Sim.rx_head + 1) % SIM_RX_QUEUE;
+    Sim.rx_count--;
+    Sim_regs.ifg2 |= UCA0RXIFG;
+    Sim_stats.rx_bytes++;
+    Sim.a0_rx_next = now + Sim_UARTByteCycles();
+  }
+}
+
+volatile uint8_t *Sim_UCA0RXBUF(void)
+{
+  Sim_Tick();
+  Sim.depth++;
+  Sim_regs.ifg2 &= ~UCA0RXIFG;
+  Sim_regs.uca0stat &= ~UCOE;
+  Sim.depth--;
+  return &Sim_regs.uca0rxbuf;
+}
+
+volatile uint8_t *Sim_UCB0RXBUF(void)
+{
+  Sim_Tick();
+  Sim.depth++;
+  Sim_regs.ifg2 &= ~UCB0RXIFG;
+  Sim_regs.ucb0stat &= ~UCOE;
+  Sim.depth--;
+  return &Sim_regs.ucb0rxbuf;
+}
+
+bool Sim_UARTInput(const uint8_t *data, uint16_t len)
+{
+  bool was_empty;
+  bool fit = true;
+
+  Sim.depth++;
+  was_empty = !Sim.rx_count;
+  while (len--)
+  {
+    if (Sim.rx_count >= SIM_RX_QUEUE)
+    {
+      fit = false;
+      break;
+    }
+    Sim.rx_queue[(Sim.rx_head + Sim.rx_count) % SIM_RX_QUEUE] = *data++;
+    Sim.rx_count++;
+  }
+  if (was_empty)
+  {
+    Sim.a0_rx_next = Sim_stats.cycles + Sim_UARTByteCycles();
+  }
+  Sim.depth--;
+  return fit;
+}
+
+//=============================================================================
+// USCI_B0 SPI and I2C
+//=============================================================================
+
+/**
+ * MCLK cycles for a number of bit clocks at the current settings.
+ * @param bits Number of SPI or SCL clocks.
+ */
+static uint64_t Sim_USCIBCycles(uint8_t bits)
+{
+  uint16_t br = Sim_regs.ucb0br0 | (Sim_regs.ucb0br1 << 8);
+  uint32_t brclk;
+
+  brclk = ((Sim_regs.ucb0ctl1 & UCSSEL_3) == UCSSEL_1) ?
+      Sim.aclk_hz : Sim.smclk_hz;
+  if (!br)
+  {
+    br = 1;
+  }
+  return Sim_ToMCLK((uint64_t)bits * br, brclk);
+}
+
+/**
+ * Step the SPI master: exchange a byte with the Sim_SetSPIFunc device for
+ * every byte written to UCB0TXBUF.
+ */
+static void Sim_SPI(uint64_t now)
+{
+  if ((Sim.b0_shift >= 0) && (now >= Sim.b0_done))
+  {
+    if (Sim_regs.ifg2 & UCB0RXIFG)
+    {
+      Sim_regs.ucb0stat |= UCOE;
+    }
+    Sim_regs.ucb0rxbuf = Sim.spi ? Sim.spi((uint8_t)Sim.b0_shift) : 0xFF;
+    Sim_regs.ifg2 |= UCB0RXIFG;
+    Sim_stats.spi_bytes++;
+    Sim.b0_shift = -1;
+  }
+  if (Sim_regs.ucb0txbuf != SIM_TXBUF_EMPTY)
+  {
+    if (Sim.b0_shift < 0)
+    {
+      Sim.b0_shift = Sim_regs.ucb0txbuf & 0xFF;
+      Sim.b0_done = now + Sim_USCIBCycles(8);
+      Sim_regs.ucb0txbuf = SIM_TXBUF_EMPTY;
+      Sim_regs.ifg2 |= UCB0TXIFG;
+    } else {
+      Sim_regs.ifg2 &= ~UCB0TXIFG;
+    }
+  }
+  if (Sim.b0_shift >= 0)
+  {
+    Sim_regs.ucb0stat |= UCBUSY;
+  } else {
+    Sim_regs.ucb0stat &= ~UCBUSY;
+  }
+}
+
+/**
+ * Send a START, or a repeated START, and the address in UCB0I2CSA.
+ */
+static void Sim_I2CStart(uint64_t now)
+{
+  Sim.b0_read = !(Sim_regs.ucb0ctl1 & UCTR);
+  Sim.b0_nacked = false;
+  Sim.b0_i2c = SIM_I2C_ADDR;
+  Sim.b0_done = now + Sim_USCIBCycles(10);
+  Sim_regs.ucb0stat |= UCBBUSY;
+  // Anything left in UCB0TXBUF from before is dropped
+  Sim_regs.ucb0txbuf = SIM_TXBUF_EMPTY;
+  if (!Sim.b0_read)
+  {
+    Sim_regs.ifg2 |= UCB0TXIFG;
+  }
+}
+
+/**
+ * Record that the device didn't acknowledge. The bus is held until the
+ * CPU asks for a STOP or a repeated START.
+ */
+static void Sim_I2CNack(void)
+{
+  Sim_regs.ucb0stat |= UCNACKIFG;
+  Sim.b0_nacked = true;
+}
+
+/**
+ * Step the I2C master, one address or data byte at a time, talking to the
+ * Sim_SetI2CDevice device. SCL is held between bytes until the CPU writes
+ * UCB0TXBUF, reads UCB0RXBUF, or sets UCTXSTT or UCTXSTP.
+ */
+static void Sim_I2C(uint64_t now)
+{
+  bool ack;
+
+  if ((Sim.b0_i2c != SIM_I2C_IDLE) && (Sim.b0_i2c != SIM_I2C_HOLD)
+      && (now >= Sim.b0_done))
+  {
+    switch (Sim.b0_i2c)
+    {
+      case SIM_I2C_ADDR:
+        Sim_regs.ucb0ctl1 &= ~UCTXSTT;
+        ack = Sim.i2c_write
+            && ((Sim_regs.ucb0i2csa & 0x7F) == Sim.i2c_address);
+        Sim.b0_i2c = SIM_I2C_HOLD;
+        if (!ack)
+        {
+          Sim_I2CNack();
+          break;
+        }
+        if (Sim.i2c_start)
+        {
+          Sim.i2c_start(Sim.b0_read);
+        }
+        if (Sim.b0_read)
+        {
+          Sim.b0_i2c = SIM_I2C_RX;
+          Sim.b0_done = now + Sim_USCIBCycles(9);
+        }
+        break;
+
+      case SIM_I2C_TX:
+        Sim_stats.i2c_bytes++;
+        Sim.b0_i2c = SIM_I2C_HOLD;
+        if (!Sim.i2c_write((uint8_t)Sim.b0_shift))
+        {
+          Sim_I2CNack();
+        }
+        break;
+
+      case SIM_I2C_RX:
+        Sim_stats.i2c_bytes++;
+        Sim_regs.ucb0rxbuf = Sim.i2c_read ? Sim.i2c_read() : 0xFF;
+        Sim_regs.ifg2 |= UCB0RXIFG;
+        // UCTXSTP set while the byte came in: it was NACKed, then STOP
+        if (Sim_regs.ucb0ctl1 & UCTXSTP)
+        {
+          Sim.b0_i2c = SIM_I2C_STOP;
+          Sim.b0_done = now + Sim_USCIBCycles(1);
+        } else {
+          Sim.b0_i2c = SIM_I2C_HOLD;
+        }
+        break;
+
+      case SIM_I2C_STOP:
+        Sim_regs.ucb0ctl1 &= ~UCTXSTP;
+        Sim_regs.ucb0stat &= ~UCBBUSY;
+        Sim.b0_i2c = SIM_I2C_IDLE;
+        break;
+    }
+  }
+
+  if (Sim.b0_i2c == SIM_I2C_IDLE)
+  {
+    // Nothing to stop
+    Sim_regs.ucb0ctl1 &= ~UCTXSTP;
+    if (Sim_regs.ucb0ctl1 & UCTXSTT)
+    {
+      Sim_I2CStart(now);
+    }
+  } else if (Sim.b0_i2c == SIM_I2C_HOLD) {
+    if (!Sim.b0_nacked && !Sim.b0_read
+        && (Sim_regs.ucb0txbuf != SIM_TXBUF_EMPTY))
+    {
+      Sim.b0_shift = Sim_regs.ucb0txbuf & 0xFF;
+      Sim_regs.ucb0txbuf = SIM_TXBUF_EMPTY;
+      Sim_regs.ifg2 |= UCB0TXIFG;
+      Sim.b0_i2c = SIM_I2C_TX;
+      Sim.b0_done = now + Sim_USCIBCycles(9);
+    } else if (Sim_regs.ucb0ctl1 & UCTXSTP) {
+      Sim.b0_i2c = SIM_I2C_STOP;
+      Sim.b0_done = now + Sim_USCIBCycles(1);
+    } else if (Sim_regs.ucb0ctl1 & UCTXSTT) {
+      Sim_I2CStart(now);
+    } else if (!Sim.b0_nacked && Sim.b0_read
+        && !(Sim_regs.ifg2 & UCB0RXIFG)) {
+      Sim.b0_i2c = SIM_I2C_RX;
+      Sim.b0_done = now + Sim_USCIBCycles(9);
+    }
+  }
+  if (Sim_regs.ucb0txbuf != SIM_TXBUF_EMPTY)
+  {
+    Sim_regs.ifg2 &= ~UCB0TXIFG;
+  }
+}
+
+/**
+ * Step USCI_B0 in whichever mode UCB0CTL0 selects.
+ */
+static void Sim_USCIB(void)
+{
+  bool i2c = ((Sim_regs.ucb0ctl0 & UCMODE_3) == UCMODE_3);
+
+  if (Sim_regs.ucb0ctl1 & UCSWRST)
+  {
+    if (!Sim.b0_reset)
+    {
+      Sim_regs.ie2 &= ~(UCB0RXIE | UCB0TXIE);
+      Sim.b0_reset = true;
+    }
+    Sim_regs.ifg2 &= ~UCB0RXIFG;
+    if (i2c)
+    {
+      Sim_regs.ifg2 &= ~UCB0TXIFG;
+    } else {
+      Sim_regs.ifg2 |= UCB0TXIFG;
+    }
+    Sim_regs.ucb0stat = 0;
+    Sim_regs.ucb0txbuf = SIM_TXBUF_EMPTY;
+    Sim.b0_shift = -1;
+    Sim.b0_i2c = SIM_I2C_IDLE;
+    return;
+  }
+  Sim.b0_reset = false;
+  if (i2c)
+  {
+    Sim_I2C(Sim_stats.cycles);
+  } else {
+    Sim_SPI(Sim_stats.cycles);
+  }
+}
+
+//=============================================================================
+// ADC10
+//=============================================================================
+
+/**
+ * MCLK cycles for one conversion at the current settings.
+ */
+static uint64_t Sim_ADCCycles(void)
+{
+  uint16_t ctl1 = Sim_regs.adc10ctl1;
+  uint32_t clocks = Sim_adc_sht[(Sim_regs.adc10ctl0 >> 11) & 3] + 13;
+  uint32_t hz;
+
+  clocks *= ((ctl1 >> 5) & 7) + 1;
+  switch (ctl1 & ADC10SSEL_3)
+  {
+    case ADC10SSEL_1:
+      hz = Sim.aclk_hz;
+      break;
+    case ADC10SSEL_2:
+      hz = Sim.mclk_hz;
+      break;
+    case ADC10SSEL_3:
+      hz = Sim.smclk_hz;
+      break;
+    default:
+      hz = 5000000UL;             // ADC10OSC
+      break;
+  }
+  return Sim_ToMCLK(clocks, hz);
+}
+
+/**
+ * Next sample for a channel.
+ */
+static uint16_t Sim_ADCSample(uint8_t channel)
+{
+  struct sim_adc_channel_t *c = &Sim.adc[channel];
+  uint16_t sample;
+
+  if (!c->count)
+  {
+    return (channel == 10) ? SIM_ADC_15T30 : 0;
+  }
+  sample = c->samples[c->next];
+  c->next = (c->next + 1) % c->count;
+  return sample & 0x3FF;
+}
+
+/**
+ * Step the ADC: start conversions, and finish them into ADC10MEM or the
+ * DTC block.
+ */
+static void Sim_ADC(void)
+{
+  uint16_t ctl0 = Sim_regs.adc10ctl0;
+  uint16_t sample;
+  bool repeat;
+
+  if ((ctl0 & ADC10SC) && (ctl0 & ENC) && (ctl0 & ADC10ON) && !Sim.adc_busy)
+  {
+    Sim_regs.adc10ctl0 &= ~ADC10SC;
+    Sim_regs.adc10ctl1 |= ADC10BUSY;
+    Sim.adc_busy = true;
+    Sim.adc_done = Sim_stats.cycles + Sim_ADCCycles();
+    Sim.adc_block = 0;
+  }
+
+  while (Sim.adc_busy && (Sim_stats.cycles >= Sim.adc_done))
+  {
+    sample = Sim_ADCSample(Sim_regs.adc10ctl1 >> 12);
+    Sim_stats.adc_conversions++;
+    repeat = (Sim_regs.adc10ctl1 & CONSEQ_2) && (Sim_regs.adc10ctl0 & MSC)
+      && (Sim_regs.adc10ctl0 & ENC);
+    if (Sim_regs.adc10dtc1)
+    {
+      ((uint16_t *)Sim_regs.adc10sa)[Sim.adc_block++] = sample;
+      if (Sim.adc_block >= Sim_regs.adc10dtc1)
+      {
+        Sim_regs.adc10ctl0 |= ADC10IFG;
+        repeat = false;
+      }
+    } else {
+      Sim_regs.adc10mem = sample;
+      Sim_regs.adc10ctl0 |= ADC10IFG;
+    }
+    if (repeat)
+    {
+      Sim.adc_done += Sim_ADCCycles();
+    } else {
+      Sim.adc_busy = false;
+      Sim_regs.adc10ctl1 &= ~ADC10BUSY;
+    }
+  }
+}
+
+bool Sim_ADCLoad(uint8_t channel, const char *path)
+{
+  struct sim_adc_channel_t *c = &Sim.adc[channel & 0x0F];
+  FILE *f = fopen(path, "r");
+  uint32_t size = 0;
+  int value;
+
+  if (!f)
+  {
+    return false;
+  }
+  Sim.depth++;
+  free(c->samples);
+  c->samples = 0;
+  c->count = 0;
+  c->next = 0;
+  while (fscanf(f, "%i", &value) == 1)
+  {
+    if (c->count == size)
+    {
+      size = size ? size * 2 : 64;
+      c->samples = realloc(c->samples, size * sizeof(uint16_t));
+    }
+    c->samples[c->count++] = value;
+  }
+  Sim.depth--;
+  fclose(f);
+  return c->count != 0;
+}
+
+//=============================================================================
+// Timer_A
+//=============================================================================
+
+/**
+ * Step one Timer_A by a number of MCLK cycles.
+ * @param t 0 for Timer0_A, 1 for Timer1_A.
+ * @param cycles MCLK cycles that have passed.
+ */
+static void Sim_Timer(uint8_t t, uint32_t cycles)
+{
+  volatile uint16_t *ctl = t ? &Sim_regs.ta1ctl : &Sim_regs.ta0ctl;
+  volatile uint16_t *r = t ? &Sim_regs.ta1r : &Sim_regs.ta0r;
+  volatile uint16_t *cctl0 = t ? &Sim_regs.ta1cctl0 : &Sim_regs.ta0cctl0;
+  uint16_t ccr0 = t ? Sim_regs.ta1ccr0 : Sim_regs.ta0ccr0;
+  uint16_t mc = *ctl & MC_3;
+  uint32_t hz;
+  uint64_t counts;
+
+  if (*ctl & TACLR)
+  {
+    *ctl &= ~TACLR;
+    *r = 0;
+    Sim.ta_acc[t] = 0;
+  }
+  if (mc == MC_0)
+  {
+    return;
+  }
+  hz = ((*ctl & TASSEL_3) == TASSEL_1) ? Sim.aclk_hz : Sim.smclk_hz;
+  hz >>= (*ctl & ID_3) >> 6;
+  Sim.ta_acc[t] += (uint64_t)cycles * hz;
+  counts = Sim.ta_acc[t] / Sim.mclk_hz;
+  Sim.ta_acc[t] %= Sim.mclk_hz;
+
+  while (counts--)
+  {
+    if ((mc != MC_2) && (*r >= ccr0))
+    {
+      *r = 0;                     // Up mode (up/down is run as up)
+      *ctl |= TAIFG;
+    } else if (++*r == 0) {
+      *ctl |= TAIFG;
+    }
+    if ((*r == ccr0) && !(*cctl0 & CAP))
+    {
+      *cctl0 |= CCIFG;
+    }
+  }
+}
+
+//=============================================================================
+// Interrupts
+//=============================================================================
+
+/**
+ * Bring the models up to date without moving time on.
+ */
+static void Sim_Update(void)
+{
+  Sim_Clocks();
+  Sim_UART();
+  Sim_USCIB();
+  Sim_ADC();
+}
+
+/**
+ * Find the highest priority pending interrupt, clearing its flag if the
+ * hardware does that when the interrupt is taken.
+ * @returns The vector, or SIM_VECTORS if none are pending.
+ */
+static uint8_t Sim_Pending(void)
+{
+  uint8_t ie = Sim_regs.ie2 & Sim_regs.ifg2;
+  uint8_t rx = UCA0RXIFG | UCB0RXIFG;
+  uint8_t tx = UCA0TXIFG | UCB0TXIFG;
+  uint8_t state = 0;
+
+  // In I2C mode USCI_B0 data flags go to the TX vector, state flags to RX
+  if ((Sim_regs.ucb0ctl0 & UCMODE_3) == UCMODE_3)
+  {
+    rx = UCA0RXIFG;
+    tx |= UCB0RXIFG;
+    state = Sim_regs.ucb0i2cie & Sim_regs.ucb0stat
+        & (UCNACKIFG | UCSTPIFG | UCSTTIFG | UCALIFG);
+  }
+
+  if ((Sim_regs.ta1cctl0 & (CCIE | CCIFG)) == (CCIE | CCIFG))
+  {
+    Sim_regs.ta1cctl0 &= ~CCIFG;
+    return SIM_TIMER1_A0;
+  }
+  if ((Sim_regs.ta0cctl0 & (CCIE | CCIFG)) == (CCIE | CCIFG))
+  {
+    Sim_regs.ta0cctl0 &= ~CCIFG;
+    return SIM_TIMER0_A0;
+  }
+  if ((ie & rx) || state)
+  {
+    return SIM_USCIAB0RX;
+  }
+  if (ie & tx)
+  {
+    return SIM_USCIAB0TX;
+  }
+  if ((Sim_regs.adc10ctl0 & (ADC10IE | ADC10IFG)) == (ADC10IE | ADC10IFG))
+  {
+    Sim_regs.adc10ctl0 &= ~ADC10IFG;
+    return SIM_ADC10;
+  }
+  return SIM_VECTORS;
+}
+
+/**
+ * Take pending interrupts until there are none left or GIE is cleared.
+ */
+static void Sim_Dispatch(void)
+{
+  volatile uint16_t saved;
+  volatile uint16_t *outer;
+  uint8_t vector;
+
+  Sim.dispatching = true;
+  while (Sim.sr & GIE)
+  {
+    Sim_Update();
+    vector = Sim_Pending();
+    if (vector == SIM_VECTORS)
+    {
+      break;
+    }
+    if (!Sim.vectors[vector])
+    {
+      fprintf(stderr, "Sim: no handler for interrupt vector %u\n", vector);
+      abort();
+    }
+    // The CPU wakes, and GIE is cleared, for the length of the ISR
+    saved = Sim.sr;
+    outer = Sim.isr_sr;
+    Sim.isr_sr = &saved;
+    Sim.sr &= ~(GIE | LPM4_bits);
+    Sim_stats.isr_calls[vector]++;
+    Sim.vectors[vector]();
+    Sim.sr = saved;
+    Sim.isr_sr = outer;
+  }
+  Sim.dispatching = false;
+}
+
+/**
+ * Move simulated time on and step the models.
+ * @param cycles MCLK cycles that have passed.
+ */
+static void Sim_Advance(uint32_t cycles)
+{
+  Sim_stats.cycles += cycles;
+  Sim_Clocks();
+  Sim_Timer(0, cycles);
+  Sim_Timer(1, cycles);
+  Sim_UART();
+  Sim_USCIB();
+  Sim_ADC();
+}
+
+void Sim_Tick(void)
+{
+  Sim.depth++;
+  if (!Sim.ticking)
+  {
+    Sim.ticking = true;
+    Sim_Advance(SIM_TICK_CYCLES);
+    Sim.ticking = false;
+  }
+  if (!Sim.dispatching && (Sim.sr & GIE))
+  {
+    Sim_Dispatch();
+  }
+  // The caller is about to read or write the register
+  Sim.accessed = 1;
+  Sim.depth--;
+}
+
+void Sim_Run(uint32_t cycles)
+{
+  uint64_t end = Sim_stats.cycles + cycles;
+
+  while (Sim_stats.cycles < end)
+  {
+    Sim_Tick();
+  }
+}
+
+/**
+ * SIGALRM handler, standing in for interrupts arriving while the code
+ * spins without touching a register.
+ * The signal can land anywhere, so the models are only run when that is
+ * safe. Nothing is done while the code is inside a Sim function, or while
+ * the simulated GIE is clear, as the CPU wouldn't take an interrupt then.
+ * Nothing is done either if a register was accessed since the last alarm,
+ * as the code may be halfway through a read-modify-write of it, and isn't
+ * stuck anyway. The models then only move on from here once the code has
+ * gone a whole SIM_ALARM_US without touching a register.
+ */
+static void Sim_Alarm(int sig)
+{
+  (void)sig;
+  if (Sim.depth)
+  {
+    return;
+  }
+  if (Sim.accessed)
+  {
+    Sim.accessed = 0;
+    return;
+  }
+  if (Sim.sr & GIE)
+  {
+    Sim_Run(SIM_ALARM_CYCLES);
+    Sim.accessed = 0;
+  }
+}
+
+//=============================================================================
+// Status Register
+//=============================================================================
+
+uint16_t Sim_GetSR(void)
+{
+  return Sim.sr;
+}
+
+void Sim_BisSR(uint16_t bits)
+{
+  Sim.depth++;
+  Sim.sr |= bits;
+  Sim.depth--;
+  Sim_Tick();
+  // Asleep: only an ISR clearing CPUOFF on exit gets us out of here
+  while (Sim.sr & CPUOFF)
+  {
+    Sim_Tick();
+  }
+}
+
+void Sim_BicSR(uint16_t bits)
+{
+  Sim.depth++;
+  Sim.sr &= ~bits;
+  Sim.depth--;
+}
+
+void Sim_BisSROnExit(uint16_t bits)
+{
+  if (Sim.isr_sr)
+  {
+    *Sim.isr_sr |= bits;
+  }
+}
+
+void Sim_BicSROnExit(uint16_t bits)
+{
+  if (Sim.isr_sr)
+  {
+    *Sim.isr_sr &= ~bits;
+  }
+}
+
+//=============================================================================
+// Set Up
+//=============================================================================
+
+/**
+ * Fill in the TLV segment the way it is laid out on a G2553, with a valid
+ * checksum.
+ */
+static void Sim_TLVInit(void)
+{
+  uint8_t *tlv = (uint8_t *)Sim_tlv;
+  uint16_t *adc = &Sim_tlv[0x1C / 2];
+  uint16_t sum = 0;
+  uint8_t i;
+
+  memset(Sim_tlv, 0xFF, sizeof(Sim_tlv));
+  tlv[0x02] = TAG_EMPTY;
+  tlv[0x03] = 0x16;
+  tlv[0x1A] = TAG_ADC10_1;
+  tlv[0x1B] = 0x10;
+  adc[CAL_ADC_GAIN_FACTOR] = 0x8000;
+  adc[CAL_ADC_OFFSET] = 0;
+  adc[CAL_ADC_15VREF_FACTOR] = 0x8000;
+  adc[CAL_ADC_15T30] = SIM_ADC_15T30;
+  adc[CAL_ADC_15T85] = SIM_ADC_15T85;
+  adc[CAL_ADC_25VREF_FACTOR] = 0x8000;
+  adc[CAL_ADC_25T30] = SIM_ADC_15T30 * 3 / 5;
+  adc[CAL_ADC_25T85] = SIM_ADC_15T85 * 3 / 5;
+  tlv[0x2C] = TAG_EMPTY;
+  tlv[0x2D] = 0x08;
+  tlv[0x36] = TAG_DCO_30;
+  tlv[0x37] = 0x08;
+  memcpy(&tlv[0x38], Sim_dco_cal, sizeof(Sim_dco_cal));
+
+  for (i = 1; i < 32; i++)
+  {
+    sum ^= Sim_tlv[i];
+  }
+  Sim_tlv[0] = -sum;
+}
+
+void Sim_Init(void)
+{
+  struct sigaction sa;
+  struct itimerval it;
+
+  Sim.depth = 1;                  // Keep a running ticker out
+  memset((void *)&Sim_regs, 0, sizeof(Sim_regs));
+  memset(&Sim_stats, 0, sizeof(Sim_stats));
+  Sim.sr = 0;
+  Sim.isr_sr = 0;
+  Sim.a0_shift = -1;
+  Sim.a0_reset = false;
+  Sim.rx_count = 0;
+  Sim.b0_shift = -1;
+  Sim.b0_reset = false;
+  Sim.b0_i2c = SIM_I2C_IDLE;
+  Sim.adc_busy = false;
+  Sim.ta_acc[0] = 0;
+  Sim.ta_acc[1] = 0;
+
+  // Power-up values
+  Sim_regs.wdtctl = 0x6900;
+  Sim_regs.dcoctl = 0x60;
+  Sim_regs.bcsctl1 = 0x87;
+  Sim_regs.uca0ctl1 = UCSWRST;
+  Sim_regs.ucb0ctl1 = UCSWRST;
+  Sim_regs.ucb0ctl0 = UCSYNC;
+  Sim_regs.ifg2 = UCA0TXIFG | UCB0TXIFG;
+  Sim_regs.uca0txbuf = SIM_TXBUF_EMPTY;
+  Sim_regs.ucb0txbuf = SIM_TXBUF_EMPTY;
+  Sim_TLVInit();
+  Sim_Clocks();
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = Sim_Alarm;
+  sa.sa_flags = SA_RESTART;
+  sigaction(SIGALRM, &sa, 0);
+  it.it_interval.tv_sec = 0;
+  it.it_interval.tv_usec = SIM_ALARM_US;
+  it.it_value = it.it_interval;
+  setitimer(ITIMER_REAL, &it, 0);
+  Sim.accessed = 0;
+  Sim.depth = 0;
+}
+
+void Sim_SetVector(uint8_t vector, void (*isr)(void))
+{
+  if (vector < SIM_VECTORS)
+  {
+    Sim.vectors[vector] = isr;
+  }
+}
+
+void Sim_SetTXFunc(void (*tx)(uint8_t byte))
+{
+  Sim.tx = tx;
+}
+
+void Sim_SetSPIFunc(uint8_t (*spi)(uint8_t byte))
+{
+  Sim.spi = spi;
+}
+
+void Sim_SetI2CDevice(
+    uint8_t address,
+    void (*start)(bool read),
+    bool (*write)(uint8_t byte),
+    uint8_t (*read)(void))
+{
+  Sim.depth++;
+  Sim.i2c_address = address;
+  Sim.i2c_start = start;
+  Sim.i2c_write = write;
+  Sim.i2c_read = read;
+  Sim.depth--;
+}
@@ -0,0 +1,311 @@
+/*
+ * @file Sim.h
+ * @brief Host peripheral models for MSP430G2xx drivers
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-16
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @details
+ * Host Builds
+ * -----------
+ *
+ *  The drivers can be built and run on a PC by putting this directory first
+ *  on the include path, so that `#include <msp430.h>` picks up the simulated
+ *  register file in host/msp430.h instead of the device header:
+ *
+ *      gcc -fcommon -Ihost -I. main.c host/Sim.c FIFO.c BCDConv.c VT100.c \
+ *          TLV.c clock.c drivers/UARTA0.c drivers/ADC10.c
+ *
+ *  BCDConv.c stands in for BCDConv.s, and -fcommon lets the buffers declared
+ *  in the driver headers be shared between files. Every register access goes through
+ *  Sim_Tick, which moves simulated time on and steps these models:
+ *
+ *  - Basic clock: MCLK, SMCLK, and ACLK follow DCOCTL, BCSCTL1-3. The
+ *    simulated TLV segment holds DCO and ADC10 calibration, so DCOSet and
+ *    ADC10_TempInit work.
+ *  - USCI_A0 UART: bytes written to UCA0TXBUF are shifted out at the baud
+ *    rate set by UCA0BRx/UCA0MCTL and handed to the Sim_SetTXFunc sink.
+ *    Bytes from Sim_UARTInput arrive in UCA0RXBUF at the same rate. TXIFG,
+ *    RXIFG, UCBUSY, UCOE, and UCSWRST behave as on the part.
+ *  - USCI_B0 SPI master: each byte written to UCB0TXBUF takes 8 bit clocks,
+ *    and the byte the Sim_SetSPIFunc device sends back lands in UCB0RXBUF.
+ *  - USCI_B0 I2C master: START, address, data, and STOP go out one byte at a
+ *    time at the SCL rate, to the device given to Sim_SetI2CDevice. UCTXSTT,
+ *    UCTXSTP, UCTR, TXIFG, RXIFG, and UCNACKIFG behave as on the part, with
+ *    I2C data interrupts on the TX vector and NACK on the RX vector.
+ *  - ADC10: conversions take the sample-and-hold plus 13 ADC10CLK cycles and
+ *    return samples from the file given to Sim_ADCLoad for that channel.
+ *    Repeat mode and the DTC are modelled.
+ *  - Timer0_A, Timer1_A: count in up or continuous mode from ACLK or SMCLK,
+ *    and set CCIFG when the count reaches CCR0.
+ *
+ *  Interrupts are raised when the IE and IFG bits and GIE are all set. The
+ *  handler registered with Sim_SetVector is then run, between two register
+ *  accesses, as if the CPU had taken the interrupt there. A SIGALRM timer
+ *  also ticks the models, so code spinning on a variable an ISR changes
+ *  (like the UART FIFO) still sees the ISR run. The ticker stays out while
+ *  a Sim function is running, while the simulated GIE is clear, and while
+ *  the code keeps accessing registers, so it only steps in for code that
+ *  has gone a whole ticker period without touching one. Entering a low
+ *  power mode with __bis_SR_register runs the models until an ISR wakes the
+ *  CPU with _bic_SR_register_on_exit.
+ *
+ *  ISR vectors can't use the msp430-gcc interrupt attribute on the host, so
+ *  guard it and register the function instead:
+ * ~~~{.c}
+ *
+ * #ifndef SIM_HOST
+ * __attribute__((interrupt(USCIAB0TX_VECTOR)))
+ * #endif
+ * void USCI_AB0_TX_ISR(void)
+ * {
+ * 	UARTA0_TX_ISR();
+ * }
+ *
+ * #ifdef SIM_HOST
+ * Sim_Init();
+ * Sim_SetVector(USCIAB0TX_VECTOR, USCI_AB0_TX_ISR);
+ * #endif
+ *
+ * ~~~
+ *
+ *  Sim_stats counts simulated cycles, bytes moved, conversions, and
+ *  interrupts taken, for working out throughput. host/SimTest.c uses them to
+ *  check the UART, RS485, ADC10, and VT100 code; run it with
+ *  `make -C host test`. Each register access counts as SIM_TICK_CYCLES
+ *  cycles, and other CPU work is not counted, so cycle figures are a lower
+ *  bound on the CPU side. Peripheral timing (baud rate, conversion time,
+ *  timer rate) is modelled exactly.
+ */
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/// Simulated cycles each register access takes
+#ifndef SIM_TICK_CYCLES
+#define SIM_TICK_CYCLES 4
+#endif
+
+/// Size of the UART receive queue fed by Sim_UARTInput
+#define SIM_RX_QUEUE 256
+
+/// UCAxTXBUF value meaning nothing has been written since the last tick
+#define SIM_TXBUF_EMPTY 0x8000
+
+/// @name Interrupt vectors, highest priority first
+/// @{
+#define SIM_TIMER1_A0  0
+#define SIM_TIMER0_A0  1
+#define SIM_USCIAB0RX  2
+#define SIM_USCIAB0TX  3
+#define SIM_ADC10      4
+#define SIM_VECTORS    5
+/// @}
+
+/**
+ * The simulated registers. Use the register names in host/msp430.h, which
+ * tick the models before each access, rather than these fields.
+ */
+struct sim_regs_t {
+  uint16_t wdtctl;
+  uint8_t dcoctl;
+  uint8_t bcsctl1;
+  uint8_t bcsctl2;
+  uint8_t bcsctl3;
+  uint8_t ie1;
+  uint8_t ifg1;
+  uint8_t ie2;
+  uint8_t ifg2;
+
+  uint8_t p1in, p1out, p1dir, p1sel, p1sel2, p1ren, p1ie, p1ies, p1ifg;
+  uint8_t p2in, p2out, p2dir, p2sel, p2sel2, p2ren, p2ie, p2ies, p2ifg;
+  uint8_t p3in, p3out, p3dir, p3sel, p3sel2, p3ren;
+
+  uint8_t uca0ctl0;
+  uint8_t uca0ctl1;
+  uint8_t uca0br0;
+  uint8_t uca0br1;
+  uint8_t uca0mctl;
+  uint8_t uca0stat;
+  uint8_t uca0rxbuf;
+  uint16_t uca0txbuf;             // SIM_TXBUF_EMPTY until written
+  uint8_t uca0abctl;
+
+  uint8_t ucb0ctl0;
+  uint8_t ucb0ctl1;
+  uint8_t ucb0br0;
+  uint8_t ucb0br1;
+  uint8_t ucb0i2cie;
+  uint8_t ucb0stat;
+  uint8_t ucb0rxbuf;
+  uint16_t ucb0txbuf;             // SIM_TXBUF_EMPTY until written
+  uint16_t ucb0i2coa;
+  uint16_t ucb0i2csa;
+
+  uint16_t adc10ctl0;
+  uint16_t adc10ctl1;
+  uint16_t adc10mem;
+  uint8_t adc10ae0;
+  uint8_t adc10dtc0;
+  uint8_t adc10dtc1;
+  uintptr_t adc10sa;              // Wide enough for a host pointer
+
+  uint16_t ta0ctl, ta0r, ta0cctl0, ta0ccr0, ta0cctl1, ta0ccr1, ta0cctl2,
+      ta0ccr2, ta0iv;
+  uint16_t ta1ctl, ta1r, ta1cctl0, ta1ccr0, ta1cctl1, ta1ccr1, ta1cctl2,
+      ta1ccr2, ta1iv;
+};
+
+typedef struct sim_regs_t Sim_Regs;
+
+struct sim_stats_t {
+  uint64_t cycles;                // Simulated MCLK cycles so far
+  uint32_t mclk_hz;               // Current simulated MCLK frequency
+  uint32_t tx_bytes;              // Bytes shifted out of UCA0TXBUF
+  uint32_t rx_bytes;              // Bytes delivered to UCA0RXBUF
+  uint32_t rx_overruns;           // Bytes lost because RXIFG was still set
+  uint32_t spi_bytes;             // Bytes exchanged over USCI_B0 SPI
+  uint32_t i2c_bytes;             // Data bytes moved over USCI_B0 I2C
+  uint32_t adc_conversions;       // ADC10 conversions finished
+  uint32_t isr_calls[SIM_VECTORS]; // Interrupts taken, by vector
+};
+
+typedef struct sim_stats_t Sim_Stats;
+
+/// The simulated register file
+extern volatile Sim_Regs Sim_regs;
+
+/// Simulation counters. Can be cleared at any time.
+extern Sim_Stats Sim_stats;
+
+/// The simulated TLV segment
+extern uint16_t Sim_tlv[32];
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Reset the registers and models, fill in the TLV segment, and start the
+ * SIGALRM ticker.
+ */
+void Sim_Init(void);
+
+/**
+ * Set the handler run when an interrupt is taken.
+ * @param vector SIM_TIMER0_A0, etc. The *_VECTOR names map to these.
+ * @param isr The handler.
+ */
+void Sim_SetVector(uint8_t vector, void (*isr)(void));
+
+/**
+ * Set where bytes shifted out of UCA0TXBUF go.
+ * This can run from the SIGALRM handler, so it shouldn't use stdio.
+ * @param tx The sink, or 0 to drop the bytes.
+ */
+void Sim_SetTXFunc(void (*tx)(uint8_t byte));
+
+/**
+ * Queue bytes to arrive at UCA0RXBUF, one per byte time.
+ * @param data Bytes to receive.
+ * @param len Number of bytes.
+ * @returns False if the queue didn't have room for all of them.
+ */
+bool Sim_UARTInput(const uint8_t *data, uint16_t len);
+
+/**
+ * Set the device on the other end of the USCI_B0 SPI bus.
+ * Chip selects are left to the test, which can look at Sim_regs.p1out.
+ * @param spi Called with each byte sent, returns the byte sent back. Or 0
+ *    for a device that always sends 0xFF.
+ */
+void Sim_SetSPIFunc(uint8_t (*spi)(uint8_t byte));
+
+/**
+ * Set the device on the USCI_B0 I2C bus.
+ * @param address 7-bit address the device answers to.
+ * @param start Called when the device is addressed, or 0.
+ * @param write Called with each byte written to the device, returns true to
+ *    acknowledge it. Or 0 for no device, so nothing is acknowledged.
+ * @param read Called for each byte read from the device, or 0 to read 0xFF.
+ */
+void Sim_SetI2CDevice(
+    uint8_t address,
+    void (*start)(bool read),
+    bool (*write)(uint8_t byte),
+    uint8_t (*read)(void));
+
+/**
+ * Load the samples an ADC10 channel returns.
+ * The file holds whitespace separated numbers, in decimal or 0x hex. They
+ * are returned in order, starting again after the last one. Channels with
+ * no file read 0, except the temperature sensor (channel 10), which reads
+ * the 30 C calibration value.
+ * @param channel The channel (0 to 15).
+ * @param path The sample file.
+ * @returns False if the file couldn't be read or held no samples.
+ */
+bool Sim_ADCLoad(uint8_t channel, const char *path);
+
+/**
+ * Let a number of cycles pass, taking interrupts as they come.
+ * Useful for letting the UART drain before reading Sim_stats.
+ * @param cycles Number of MCLK cycles.
+ */
+void Sim_Run(uint32_t cycles);
+
+/**
+ * Step the models by SIM_TICK_CYCLES and take any pending interrupts.
+ * Called by every register access.
+ */
+void Sim_Tick(void);
+
+/**
+ * Read UCA0RXBUF, which clears UCA0RXIFG. Use UCA0RXBUF instead.
+ */
+volatile uint8_t *Sim_UCA0RXBUF(void);
+
+/**
+ * Read UCB0RXBUF, which clears UCB0RXIFG. Use UCB0RXBUF instead.
+ */
+volatile uint8_t *Sim_UCB0RXBUF(void);
+
+/// @name Intrinsics
+/// @{
+uint16_t Sim_GetSR(void);
+void Sim_BisSR(uint16_t bits);
+void Sim_BicSR(uint16_t bits);
+void Sim_BisSROnExit(uint16_t bits);
+void Sim_BicSROnExit(uint16_t bits);
+/// @}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SIM_H_ */
@@ -0,0 +1,767 @@
+/*
+ * @file SimTest.c
+ * @brief Checks of the drivers running on the host peripheral models
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-16
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @details
+ *  Runs FIFO, UARTA0, RS485A, ADC10, SPIB0, I2CB0, and VT100 unmodified
+ *  against Sim.c, and checks the bytes they put on the wire, the interrupts
+ *  they take, and the throughput they get against what the hardware would
+ *  do. SPIB0 and I2CB0 talk to the small devices under SPI and I2C Devices.
+ *  Prints a line per check and exits nonzero if any fail. Built and run by
+ *  `make test` in this directory. The ADC10 samples come from SimTest.adc,
+ *  or the file given as the first argument.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <msp430.h>
+#include "clock.h"
+#include "drivers/UARTA0.h"
+#include "drivers/RS485A.h"
+#include "drivers/ADC10.h"
+#include "drivers/SPIB0.h"
+#include "drivers/I2CB0.h"
+#include "VT100.h"
+
+/// Allowed throughput error, in percent of the line rate
+#define SIMTEST_RATE_TOLERANCE 1
+
+/// Samples in SimTest.adc
+static const uint16_t SimTest_samples[] = {
+  0, 1, 2, 511, 512, 1023, 0x155, 0x2AA,
+};
+
+#define SIMTEST_SAMPLES (sizeof(SimTest_samples) / sizeof(SimTest_samples[0]))
+
+static uint8_t SimTest_out[1024];
+static uint16_t SimTest_out_len;
+static uint8_t SimTest_sent[sizeof(SimTest_out)];
+static uint16_t SimTest_sent_len;
+static uint64_t SimTest_first;      // Cycle the first byte finished on
+static uint64_t SimTest_last;       // Cycle the last byte finished on
+static uint16_t SimTest_failures;
+
+//=============================================================================
+// Helpers
+//=============================================================================
+
+/**
+ * Record bytes shifted out of UCA0TXBUF, and when they finished.
+ */
+static void SimTest_Sink(uint8_t byte)
+{
+  if (SimTest_out_len < sizeof(SimTest_out))
+  {
+    SimTest_out[SimTest_out_len] = byte;
+  }
+  if (!SimTest_out_len)
+  {
+    SimTest_first = Sim_stats.cycles;
+  }
+  SimTest_last = Sim_stats.cycles;
+  SimTest_out_len++;
+}
+
+/**
+ * Record bytes VT100.c hands to the driver, then send them with UARTA0_Send.
+ */
+static void SimTest_Send(char c)
+{
+  if (SimTest_sent_len < sizeof(SimTest_sent))
+  {
+    SimTest_sent[SimTest_sent_len] = c;
+  }
+  SimTest_sent_len++;
+  UARTA0_Send(c);
+}
+
+/**
+ * Print the result of one check and count failures.
+ * @param ok True if the check passed.
+ * @param what What was checked, with the measured figures.
+ */
+static void SimTest_Check(bool ok, const char *what)
+{
+  printf("%s  %s\n", ok ? "ok  " : "FAIL", what);
+  if (!ok)
+  {
+    SimTest_failures++;
+  }
+}
+
+/**
+ * Clear the counters and the captured output.
+ */
+static void SimTest_Reset(void)
+{
+  memset(&Sim_stats, 0, sizeof(Sim_stats));
+  SimTest_out_len = 0;
+  SimTest_sent_len = 0;
+}
+
+/**
+ * Check a transmit run against the line rate.
+ * Throughput is timed from the end of the first byte to the end of the last
+ * one, so it doesn't depend on when the run started, and shows any gaps the
+ * driver left between bytes.
+ * @param name Name of the run.
+ * @param sent The bytes handed to the driver.
+ * @param len Number of bytes handed to the driver.
+ * @param baud The baud rate.
+ */
+static void SimTest_CheckTX(
+    const char *name,
+    const uint8_t *sent,
+    uint16_t len,
+    uint32_t baud)
+{
+  char what[128];
+  uint32_t isrs = Sim_stats.isr_calls[SIM_USCIAB0TX];
+  double rate = (double)(SimTest_out_len - 1) * Clock_cfg.mclk_hz
+      / (SimTest_last - SimTest_first);
+  double line = baud / 10.0;
+
+  snprintf(what, sizeof(what), "%s: %u of %u bytes emitted", name,
+      (unsigned)Sim_stats.tx_bytes, (unsigned)len);
+  SimTest_Check((Sim_stats.tx_bytes == len) && (SimTest_out_len == len)
+      && (len <= sizeof(SimTest_out)) && !memcmp(SimTest_out, sent, len),
+      what);
+
+  // One interrupt per byte, plus one to find the FIFO empty. The first byte
+  // may go straight into TXBUF.
+  snprintf(what, sizeof(what), "%s: %u TX interrupts for %u bytes", name,
+      (unsigned)isrs, (unsigned)len);
+  SimTest_Check((isrs + 1 >= len) && (isrs <= len + 1U), what);
+
+  snprintf(what, sizeof(what), "%s: %.1f bytes/s, line rate %.1f", name,
+      rate, line);
+  SimTest_Check((rate <= line * (100 + SIMTEST_RATE_TOLERANCE) / 100)
+      && (rate >= line * (100 - SIMTEST_RATE_TOLERANCE) / 100), what);
+}
+
+//=============================================================================
+// SPI and I2C Devices
+//=============================================================================
+
+/// Chip selects of the two SPI devices, in P1OUT
+#define SIMTEST_CS_A BIT3
+#define SIMTEST_CS_B BIT4
+
+/// I2C address of the register device, and one nobody answers
+#define SIMTEST_I2C_ADDRESS 0x48
+#define SIMTEST_I2C_ABSENT  0x49
+
+static uint8_t SimTest_bus[64];     // Bytes the SPI devices were sent
+static uint8_t SimTest_bus_cs[64];  // Chip selects low for each of them
+static uint16_t SimTest_bus_len;
+
+static uint8_t SimTest_reg[8];      // I2C device registers
+static uint8_t SimTest_reg_ptr;     // Register the next byte goes to
+static bool SimTest_reg_first;      // Next byte written is a register number
+static uint8_t SimTest_written;     // Bytes written since the last START
+static uint8_t SimTest_nack_at;     // Written byte to NACK, from 1, or 0
+
+/**
+ * SPI devices: log each byte with the chip selects that were low, and
+ * answer with 0x80 plus the byte's position on the bus from device A, 0x40
+ * plus it from device B, or 0xEE if not exactly one of them was selected.
+ */
+static uint8_t SimTest_SPI(uint8_t byte)
+{
+  uint8_t cs = ~Sim_regs.p1out & (SIMTEST_CS_A | SIMTEST_CS_B);
+  uint16_t n = SimTest_bus_len;
+
+  if (n < sizeof(SimTest_bus))
+  {
+    SimTest_bus[n] = byte;
+    SimTest_bus_cs[n] = cs;
+  }
+  SimTest_bus_len++;
+  if (cs == SIMTEST_CS_A)
+  {
+    return 0x80 + n;
+  }
+  return (cs == SIMTEST_CS_B) ? 0x40 + n : 0xEE;
+}
+
+/**
+ * I2C device, START or repeated START: a write starts with the register
+ * number.
+ */
+static void SimTest_I2CStart(bool read)
+{
+  if (!read)
+  {
+    SimTest_reg_first = true;
+    SimTest_written = 0;
+  }
+}
+
+/**
+ * I2C device, byte written: set the register number, or store the byte in
+ * the next register. Byte SimTest_nack_at is NACKed and not stored.
+ */
+static bool SimTest_I2CWrite(uint8_t byte)
+{
+  if (++SimTest_written == SimTest_nack_at)
+  {
+    return false;
+  }
+  if (SimTest_reg_first)
+  {
+    SimTest_reg_ptr = byte;
+    SimTest_reg_first = false;
+  } else {
+    SimTest_reg[SimTest_reg_ptr++ % sizeof(SimTest_reg)] = byte;
+  }
+  return true;
+}
+
+/**
+ * I2C device, byte read: the next register.
+ */
+static uint8_t SimTest_I2CRead(void)
+{
+  return SimTest_reg[SimTest_reg_ptr++ % sizeof(SimTest_reg)];
+}
+
+//=============================================================================
+// Interrupt Handlers
+//=============================================================================
+
+static bool SimTest_rs485;
+static bool SimTest_i2c;            // USCI_B0 runs I2CB0, not SPIB0
+
+#ifndef SIM_HOST
+__attribute__((interrupt(USCIAB0RX_VECTOR)))
+#endif
+static void SimTest_RX_ISR(void)
+{
+  if (SimTest_rs485)
+  {
+    RS485A_Rx_ISR();
+  } else if ((IFG2 & UCA0RXIFG) && (IE2 & UCA0RXIE)) {
+    UARTA0_RX_ISR();
+  }
+  if (SimTest_i2c ? I2CB0_State_ISR() : SPIB0_RX_ISR())
+  {
+    _bic_SR_register_on_exit(LPM0_bits);
+  }
+}
+
+#ifndef SIM_HOST
+__attribute__((interrupt(USCIAB0TX_VECTOR)))
+#endif
+static void SimTest_TX_ISR(void)
+{
+  if (SimTest_rs485)
+  {
+    RS485A_Tx_ISR();
+  } else if ((IFG2 & UCA0TXIFG) && (IE2 & UCA0TXIE)) {
+    UARTA0_TX_ISR();
+  }
+  if (SimTest_i2c && I2CB0_Data_ISR())
+  {
+    _bic_SR_register_on_exit(LPM0_bits);
+  }
+}
+
+#ifndef SIM_HOST
+__attribute__((interrupt(ADC10_VECTOR)))
+#endif
+static void SimTest_ADC10_ISR(void)
+{
+  ADC10_ISR();
+}
+
+//=============================================================================
+// Checks
+//=============================================================================
+
+/**
+ * Send a block through UARTA0 at a given clock and baud rate.
+ * @param freq TLV_DCO_* frequency to run at.
+ * @param baud Baud rate.
+ */
+static void SimTest_UARTA0_TX(uint8_t freq, uint32_t baud)
+{
+  uint8_t data[200];
+  char name[32];
+  uint16_t i;
+
+  DCOSet(freq);
+  UARTA0_SetBaud(baud);
+  for (i = 0; i < sizeof(data); i++)
+  {
+    data[i] = i * 7;
+  }
+  SimTest_Reset();
+  UARTA0_Write((const char *)data, sizeof(data));
+  while (IE2 & UCA0TXIE);           // Until the TX ISR finds the FIFO empty
+  while (UCA0STAT & UCBUSY);
+  snprintf(name, sizeof(name), "UARTA0 TX %lu baud", (unsigned long)baud);
+  SimTest_CheckTX(name, data, sizeof(data), baud);
+}
+
+/**
+ * Receive a block through UARTA0.
+ * @param baud The baud rate UARTA0 was set to.
+ */
+static void SimTest_UARTA0_RX(uint32_t baud)
+{
+  uint8_t data[UARTA0_RX_BUFFER_SIZE - 1];
+  char what[128];
+  uint16_t got = 0;
+  bool same = true;
+  uint16_t i;
+
+  for (i = 0; i < sizeof(data); i++)
+  {
+    data[i] = 0xFF - i;
+  }
+  SimTest_Reset();
+  Sim_UARTInput(data, sizeof(data));
+  Sim_Run(Clock_cfg.mclk_hz / (baud / 10) * (sizeof(data) + 1));
+  while (!UARTA0_Empty())
+  {
+    same = same && (got < sizeof(data)) && (UARTA0_Receive() == data[got]);
+    got++;
+  }
+  snprintf(what, sizeof(what), "UARTA0 RX: %u of %u bytes received, %u "
+      "overruns", got, (unsigned)sizeof(data),
+      (unsigned)Sim_stats.rx_overruns);
+  SimTest_Check(same && (got == sizeof(data)) && !Sim_stats.rx_overruns,
+      what);
+  snprintf(what, sizeof(what), "UARTA0 RX: %u RX interrupts for %u bytes",
+      (unsigned)Sim_stats.isr_calls[SIM_USCIAB0RX], (unsigned)sizeof(data));
+  SimTest_Check(Sim_stats.isr_calls[SIM_USCIAB0RX] == sizeof(data), what);
+}
+
+/**
+ * Send a block through RS485A, which shares USCI_A0 with UARTA0.
+ * @param baud Baud rate.
+ */
+static void SimTest_RS485A_TX(uint32_t baud)
+{
+  uint8_t data[100];
+  uint16_t i;
+
+  SimTest_rs485 = true;
+  RS485A_Init(RS485A_SMCLK, 104, 0, 0, UCBRS0, 0, 0, 0);
+  RS485A_SetBaud(baud);
+  RS485A_EnableInterrupts();
+  for (i = 0; i < sizeof(data); i++)
+  {
+    data[i] = 'A' + (i % 26);
+  }
+  SimTest_Reset();
+  for (i = 0; i < sizeof(data); i++)
+  {
+    RS485A_Send(data[i]);
+  }
+  while (IE2 & UCA0TXIE);
+  while (UCA0STAT & UCBUSY);
+  SimTest_CheckTX("RS485A TX", data, sizeof(data), baud);
+  SimTest_rs485 = false;
+}
+
+/**
+ * Read the sample file through the blocking and the polled ADC10 calls.
+ * @param path The sample file, holding SimTest_samples.
+ */
+static void SimTest_ADC10(const char *path)
+{
+  uint16_t block[SIMTEST_SAMPLES];
+  char what[128];
+  uint16_t value;
+  uint16_t bad = 0;
+  uint16_t i;
+
+  if (!Sim_ADCLoad(3, path))
+  {
+    snprintf(what, sizeof(what), "ADC10: can't read %s", path);
+    SimTest_Check(false, what);
+    return;
+  }
+  SimTest_Reset();
+  for (i = 0; i < SIMTEST_SAMPLES; i++)
+  {
+    bad += ADC10_AnalogRead(3) != SimTest_samples[i];
+  }
+  snprintf(what, sizeof(what), "ADC10 read: %u of %u samples match, %u "
+      "conversions", (unsigned)(SIMTEST_SAMPLES - bad),
+      (unsigned)SIMTEST_SAMPLES, (unsigned)Sim_stats.adc_conversions);
+  SimTest_Check(!bad && (Sim_stats.adc_conversions == SIMTEST_SAMPLES),
+      what);
+
+  SimTest_Reset();
+  for (i = 0; i < SIMTEST_SAMPLES; i++)
+  {
+    while (!ADC10_AnalogPoll(3, &value));
+    bad += value != SimTest_samples[i];
+  }
+  snprintf(what, sizeof(what), "ADC10 poll: %u of %u samples match, %u "
+      "ADC10 interrupts", (unsigned)(SIMTEST_SAMPLES - bad),
+      (unsigned)SIMTEST_SAMPLES, (unsigned)Sim_stats.isr_calls[SIM_ADC10]);
+  SimTest_Check(!bad && (Sim_stats.isr_calls[SIM_ADC10] == SIMTEST_SAMPLES),
+      what);
+
+  // A block read must convert against the reference already set up
+  Sim_ADCLoad(3, path);
+  SimTest_Reset();
+  ADC10CTL0 |= SREF_1 | REFON;
+  ADC10_AnalogReadBlock(3, block, SIMTEST_SAMPLES);
+  for (i = 0; i < SIMTEST_SAMPLES; i++)
+  {
+    bad += block[i] != SimTest_samples[i];
+  }
+  snprintf(what, sizeof(what), "ADC10 block: %u of %u samples match, "
+      "reference %s", (unsigned)(SIMTEST_SAMPLES - bad),
+      (unsigned)SIMTEST_SAMPLES,
+      ((ADC10CTL0 & (SREF_1 | REFON)) == (SREF_1 | REFON)) ? "kept" : "lost");
+  SimTest_Check(!bad
+      && ((ADC10CTL0 & (SREF_1 | REFON)) == (SREF_1 | REFON)), what);
+  ADC10CTL0 &= ~(SREF_1 | REFON);
+}
+
+static SPIB0_Xfer *SimTest_spi_done[4];  // SPIB0 transfers, as they finished
+static uint8_t SimTest_spi_done_len;
+static SPIB0_Xfer *SimTest_spi_next;     // Queued by the next one to finish
+
+/**
+ * SPIB0 transfer done: note the order, and queue SimTest_spi_next if set.
+ */
+static void SimTest_SPIB0_Done(SPIB0_Xfer *xfer)
+{
+  if (SimTest_spi_done_len < 4)
+  {
+    SimTest_spi_done[SimTest_spi_done_len] = xfer;
+  }
+  SimTest_spi_done_len++;
+  if (SimTest_spi_next)
+  {
+    SPIB0_Queue(SimTest_spi_next);
+    SimTest_spi_next = 0;
+  }
+}
+
+/**
+ * Run queued and chained reads, and one-byte transfers, through SPIB0.
+ */
+static void SimTest_SPIB0(void)
+{
+  static const uint8_t read_cmd[] = { 0x03, 0x00, 0x10 };
+  static const uint8_t id_cmd[] = { 0x9F };
+  static const uint8_t one = 0xA5;
+  // Device A gets read_cmd and 4 fill bytes, B id_cmd and 3, then A 2 more
+  static const uint8_t bus[] = {
+    0x03, 0x00, 0x10, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x9F, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF,
+  };
+  static const uint8_t bus_cs[] = {
+    SIMTEST_CS_A, SIMTEST_CS_A, SIMTEST_CS_A, SIMTEST_CS_A, SIMTEST_CS_A,
+    SIMTEST_CS_A, SIMTEST_CS_A,
+    SIMTEST_CS_B, SIMTEST_CS_B, SIMTEST_CS_B, SIMTEST_CS_B,
+    SIMTEST_CS_A, SIMTEST_CS_A,
+  };
+  static const uint8_t rx_a[] = { 0x83, 0x84, 0x85, 0x86 };
+  static const uint8_t rx_b[] = { 0x48, 0x49, 0x4A };
+  static const uint8_t rx_c[] = { 0x8B, 0x8C };
+  uint8_t got_a[4], got_b[3], got_c[2], got_one;
+  SPIB0_Xfer a = {
+    .tx = read_cmd, .tx_len = 3, .rx = got_a, .rx_len = 4,
+    .cs = SIMTEST_CS_A, .callback = SimTest_SPIB0_Done,
+  };
+  SPIB0_Xfer b = {
+    .tx = id_cmd, .tx_len = 1, .rx = got_b, .rx_len = 3,
+    .cs = SIMTEST_CS_B, .callback = SimTest_SPIB0_Done,
+  };
+  SPIB0_Xfer c = {
+    .rx = got_c, .rx_len = 2,
+    .cs = SIMTEST_CS_A, .callback = SimTest_SPIB0_Done,
+  };
+  SPIB0_Xfer write = { .tx = &one, .tx_len = 1, .cs = SIMTEST_CS_B };
+  SPIB0_Xfer read = { .rx = &got_one, .rx_len = 1, .cs = SIMTEST_CS_A };
+  char what[128];
+  bool deselected;
+
+  SimTest_i2c = false;
+  P1OUT |= SIMTEST_CS_A | SIMTEST_CS_B;
+  P1DIR |= SIMTEST_CS_A | SIMTEST_CS_B;
+  Sim_SetSPIFunc(SimTest_SPI);
+  SPIB0_Init(SPIB0_SMCLK, 2, SPIB0_MODE_0);
+
+  // a and b are queued together, and a's callback queues c behind b
+  SimTest_Reset();
+  SimTest_bus_len = 0;
+  SimTest_spi_done_len = 0;
+  SimTest_spi_next = &c;
+  SPIB0_Queue(&a);
+  SPIB0_Queue(&b);
+  SPIB0_Wait(&b);
+  SPIB0_Wait(&c);
+  deselected = (P1OUT & (SIMTEST_CS_A | SIMTEST_CS_B))
+      == (SIMTEST_CS_A | SIMTEST_CS_B);
+  snprintf(what, sizeof(what), "SPIB0 chained: %u of %u bytes on the bus, "
+      "%u RX interrupts", (unsigned)SimTest_bus_len, (unsigned)sizeof(bus),
+      (unsigned)Sim_stats.isr_calls[SIM_USCIAB0RX]);
+  SimTest_Check((SimTest_bus_len == sizeof(bus))
+      && (Sim_stats.spi_bytes == sizeof(bus))
+      && (Sim_stats.isr_calls[SIM_USCIAB0RX] == sizeof(bus))
+      && !memcmp(SimTest_bus, bus, sizeof(bus))
+      && !memcmp(SimTest_bus_cs, bus_cs, sizeof(bus_cs)), what);
+  snprintf(what, sizeof(what), "SPIB0 chained: %u transfers done in order, "
+      "chip selects %s", (unsigned)SimTest_spi_done_len,
+      deselected ? "released" : "held");
+  SimTest_Check((SimTest_spi_done_len == 3) && (SimTest_spi_done[0] == &a)
+      && (SimTest_spi_done[1] == &b) && (SimTest_spi_done[2] == &c)
+      && (a.status == SPIB0_DONE) && (b.status == SPIB0_DONE)
+      && (c.status == SPIB0_DONE) && deselected && !SPIB0_Busy(), what);
+  snprintf(what, sizeof(what), "SPIB0 chained: read data %s",
+      (!memcmp(got_a, rx_a, sizeof(rx_a)) && !memcmp(got_b, rx_b, sizeof(rx_b))
+      && !memcmp(got_c, rx_c, sizeof(rx_c))) ? "matches" : "differs");
+  SimTest_Check(!memcmp(got_a, rx_a, sizeof(rx_a))
+      && !memcmp(got_b, rx_b, sizeof(rx_b))
+      && !memcmp(got_c, rx_c, sizeof(rx_c)), what);
+
+  SimTest_Reset();
+  SimTest_bus_len = 0;
+  SPIB0_Queue(&write);
+  SPIB0_Queue(&read);
+  SPIB0_Wait(&read);
+  snprintf(what, sizeof(what), "SPIB0 one byte: sent 0x%02X to %s, read "
+      "0x%02X", SimTest_bus[0],
+      (SimTest_bus_cs[0] == SIMTEST_CS_B) ? "B" : "?", got_one);
+  SimTest_Check((SimTest_bus_len == 2) && (SimTest_bus[0] == one)
+      && (SimTest_bus_cs[0] == SIMTEST_CS_B) && (SimTest_bus[1] == SPIB0_FILL)
+      && (SimTest_bus_cs[1] == SIMTEST_CS_A) && (got_one == 0x81)
+      && (write.status == SPIB0_DONE) && (read.status == SPIB0_DONE), what);
+
+  Sim_SetSPIFunc(0);
+}
+
+/**
+ * Check how an I2CB0 transfer ended, and what it read.
+ * @param name Name of the transfer.
+ * @param xfer The transfer.
+ * @param status I2CB0_DONE or I2CB0_NACK.
+ * @param rx The bytes it should have read, rx_len of them.
+ */
+static void SimTest_I2CB0_Check(
+    const char *name,
+    const I2CB0_Xfer *xfer,
+    uint8_t status,
+    const uint8_t *rx)
+{
+  char what[128];
+
+  snprintf(what, sizeof(what), "I2CB0 %s: %s", name,
+      (xfer->status == I2CB0_DONE) ? "done" :
+      (xfer->status == I2CB0_NACK) ? "NACK" : "queued");
+  SimTest_Check((xfer->status == status)
+      && (!xfer->rx_len || !memcmp(xfer->rx, rx, xfer->rx_len)), what);
+}
+
+/**
+ * Run register writes and reads, probes, and transfers cut short by a NACK
+ * through I2CB0, each NACK followed by a transfer that has to succeed.
+ */
+static void SimTest_I2CB0(void)
+{
+  static const uint8_t write_2[] = { 2, 0xA5, 0x5A };
+  static const uint8_t reg_2 = 2;
+  static const uint8_t reg_3 = 3;
+  static const uint8_t write_4[] = { 4, 0xC3, 0x3C };
+  static const uint8_t read_2[] = { 0xA5, 0x5A };
+  static const uint8_t read_4[] = { 0x44, 0x55 };
+  static const uint8_t read_4_last[] = { 0xC3, 0x55 };
+  uint8_t got[2];
+  I2CB0_Xfer write = {
+    .address = SIMTEST_I2C_ADDRESS, .tx = write_2, .tx_len = 3,
+  };
+  I2CB0_Xfer read = {
+    .address = SIMTEST_I2C_ADDRESS, .tx = &reg_2, .tx_len = 1,
+    .rx = got, .rx_len = 2,
+  };
+  I2CB0_Xfer read_one = {
+    .address = SIMTEST_I2C_ADDRESS, .tx = &reg_3, .tx_len = 1,
+    .rx = got, .rx_len = 1,
+  };
+  I2CB0_Xfer probe = { .address = SIMTEST_I2C_ADDRESS };
+  I2CB0_Xfer absent = { .address = SIMTEST_I2C_ABSENT };
+  I2CB0_Xfer nacked = {
+    .address = SIMTEST_I2C_ABSENT, .tx = write_4, .tx_len = 3,
+  };
+  I2CB0_Xfer recover = {
+    .address = SIMTEST_I2C_ADDRESS, .tx = write_4, .tx_len = 1,
+    .rx = got, .rx_len = 2,
+  };
+  static const char *const nack_on[] = {
+    "the address", "a middle byte", "the last byte",
+  };
+  char what[128];
+  uint8_t i;
+
+  for (i = 0; i < sizeof(SimTest_reg); i++)
+  {
+    SimTest_reg[i] = i * 0x11;
+  }
+  SimTest_nack_at = 0;
+  SimTest_i2c = true;
+  Sim_SetI2CDevice(SIMTEST_I2C_ADDRESS, SimTest_I2CStart, SimTest_I2CWrite,
+      SimTest_I2CRead);
+  I2CB0_Init(I2CB0_SMCLK, 160);
+
+  SimTest_Reset();
+  I2CB0_Queue(&write);
+  I2CB0_Wait(&write);
+  SimTest_I2CB0_Check("register write", &write, I2CB0_DONE, 0);
+  snprintf(what, sizeof(what), "I2CB0 register write: registers 2, 3 = "
+      "0x%02X 0x%02X, %u bytes", SimTest_reg[2], SimTest_reg[3],
+      (unsigned)Sim_stats.i2c_bytes);
+  SimTest_Check((SimTest_reg[2] == 0xA5) && (SimTest_reg[3] == 0x5A)
+      && (Sim_stats.i2c_bytes == 3), what);
+
+  I2CB0_Queue(&read);
+  I2CB0_Wait(&read);
+  SimTest_I2CB0_Check("register read", &read, I2CB0_DONE, read_2);
+  I2CB0_Queue(&read_one);
+  I2CB0_Wait(&read_one);
+  SimTest_I2CB0_Check("one-byte read", &read_one, I2CB0_DONE, &read_2[1]);
+
+  SimTest_Reset();
+  I2CB0_Queue(&probe);
+  I2CB0_Queue(&absent);
+  I2CB0_Wait(&absent);
+  SimTest_I2CB0_Check("probe 0x48", &probe, I2CB0_DONE, 0);
+  SimTest_I2CB0_Check("probe 0x49", &absent, I2CB0_NACK, 0);
+  snprintf(what, sizeof(what), "I2CB0 probes: %u data bytes",
+      (unsigned)Sim_stats.i2c_bytes);
+  SimTest_Check(!Sim_stats.i2c_bytes, what);
+
+  // A NACK on the address, a middle byte, then the last byte, each with a
+  // read of registers 4 and 5 queued right behind it
+  for (i = 1; i <= 3; i++)
+  {
+    if (i > 1)
+    {
+      nacked.address = SIMTEST_I2C_ADDRESS;
+      SimTest_nack_at = i;
+    }
+    I2CB0_Queue(&nacked);
+    I2CB0_Queue(&recover);
+    I2CB0_Wait(&recover);
+    SimTest_nack_at = 0;
+    snprintf(what, sizeof(what), "NACK on %s", nack_on[i - 1]);
+    SimTest_I2CB0_Check(what, &nacked, I2CB0_NACK, 0);
+    snprintf(what, sizeof(what), "read after the NACK on %s", nack_on[i - 1]);
+    SimTest_I2CB0_Check(what, &recover, I2CB0_DONE,
+        (i == 3) ? read_4_last : read_4);
+    SimTest_reg[4] = 0x44;
+  }
+  // The last read's STOP goes out after the transfer is done
+  while (UCB0CTL1 & UCTXSTP);
+  snprintf(what, sizeof(what), "I2CB0 bus %s after the NACKs",
+      (UCB0STAT & (UCBBUSY | UCNACKIFG)) ? "held" : "free");
+  SimTest_Check(!(UCB0STAT & (UCBBUSY | UCNACKIFG)) && !I2CB0_Busy(), what);
+
+  Sim_SetI2CDevice(0, 0, 0, 0);
+  SimTest_i2c = false;
+}
+
+/**
+ * Send VT100 output through UARTA0.
+ * @param baud The baud rate UARTA0 was set to.
+ */
+static void SimTest_VT100(uint32_t baud)
+{
+  char what[128];
+  gui_item bar;
+  uint32_t bytes;
+  uint8_t i;
+
+  VT_SetTXFunc(SimTest_Send);
+  VT_Bytes_Reset();
+  SimTest_Reset();
+  VT_Clear();
+  VT_Box(1, 1, 24, 4);
+  VT_HBar_Init(3, 2, 20, &bar);
+  for (i = 0; i <= 20; i++)
+  {
+    bar.val2 = i;
+    VT_HBar_Draw(&bar);
+  }
+  while (IE2 & UCA0TXIE);
+  while (UCA0STAT & UCBUSY);
+  bytes = VT_Bytes();
+  SimTest_CheckTX("VT100 over UARTA0", SimTest_sent, SimTest_sent_len, baud);
+  snprintf(what, sizeof(what), "VT100 over UARTA0: VT_Bytes %lu, sent %u, "
+      "emitted %u", (unsigned long)bytes, (unsigned)SimTest_sent_len,
+      (unsigned)Sim_stats.tx_bytes);
+  SimTest_Check((bytes == SimTest_sent_len)
+      && (bytes == Sim_stats.tx_bytes), what);
+}
+
+//=============================================================================
+// Main
+//=============================================================================
+
+int main(int argc, char *argv[])
+{
+  const char *adc = (argc > 1) ? argv[1] : "SimTest.adc";
+
+  Sim_Init();
+  Sim_SetTXFunc(SimTest_Sink);
+  Sim_SetVector(USCIAB0RX_VECTOR, SimTest_RX_ISR);
+  Sim_SetVector(USCIAB0TX_VECTOR, SimTest_TX_ISR);
+  Sim_SetVector(ADC10_VECTOR, SimTest_ADC10_ISR);
+
+  WatchdogOff();
+  DCO1MHz();
+  Clock_Register(UARTA0_ClockNotify);
+  Clock_Register(ADC10_ClockNotify);
+  ADC10_ClockNotify(CLOCK_POST_CHANGE);
+  UARTA0_Init(UARTA0_SMCLK, 104, 0, 0, UCBRS0, 0, 0, 0);
+  UARTA0_EnableInterrupts();
+  __enable_interrupt();
+
+  SimTest_UARTA0_TX(TLV_DCO_1MHZ, 9600);
+  SimTest_UARTA0_RX(9600);
+  SimTest_VT100(9600);
+  SimTest_UARTA0_TX(TLV_DCO_16MHZ, 115200);
+  SimTest_UARTA0_RX(115200);
+  SimTest_VT100(115200);
+  SimTest_ADC10(adc);
+  SimTest_RS485A_TX(9600);
+  SimTest_SPIB0();
+  SimTest_I2CB0();
+
+  printf("%u failed\n", SimTest_failures);
+  return SimTest_failures ? 1 : 0;
+}
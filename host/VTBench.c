@@ -0,0 +1,506 @@
+/*
+ * @file VTBench.c
+ * @brief VT100 output size benchmark
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-16
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @details
+ *  Replays scripted widget sessions through VT100.c with a counting sink in
+ *  VT_SetTXFunc, and reports the bytes each one sends and how long that takes
+ *  on the line at 9600 and 115200 baud. Each result is checked against
+ *  VTBench.baseline (or the file given as the first argument), and the run
+ *  fails if any session sends more than its baseline.
+ *
+ *  When a change makes output smaller, lower the baseline to match, so the
+ *  gain is kept. `VTBench -p` prints the current results in baseline form.
+ *  Built and run by `make bench` in this directory.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "VT100.h"
+
+/// Longest session name
+#define VTBENCH_NAME_LEN 32
+
+/// A scripted session
+struct vtbench_session_t {
+  const char *name;
+  void (*setup)(void);            // Draws whatever the session starts from
+  void (*run)(void);              // The part that is counted
+};
+
+typedef struct vtbench_session_t VTBench_Session;
+
+static uint32_t VTBench_bytes;
+
+static gui_item VTBench_a;
+static vt_widget VTBench_widgets[3];
+static VT_Panel VTBench_panel;
+static vt_cell VTBench_cells[80 * 24];
+static uint8_t VTBench_ring[6];
+
+//=============================================================================
+// Counting Sink
+//=============================================================================
+
+static void VTBench_TX(char c)
+{
+  (void)c;
+  VTBench_bytes++;
+}
+
+//=============================================================================
+// Sessions
+//=============================================================================
+
+static void VTBench_HSlide_Setup(void)
+{
+  VT_HSlide_Init(5, 2, 20, &VTBench_a);
+  VT_HSlide_Draw(&VTBench_a);
+}
+
+static void VTBench_HSlide_Step(void)
+{
+  VT_HSlide_Handle(VT_KEY_RIGHT, &VTBench_a);
+}
+
+static void VTBench_HSlide_Drag(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < 20; i++)
+  {
+    VT_HSlide_Handle(VT_KEY_RIGHT, &VTBench_a);
+  }
+  for (i = 0; i < 20; i++)
+  {
+    VT_HSlide_Handle(VT_KEY_LEFT, &VTBench_a);
+  }
+}
+
+static void VTBench_VSlide_Setup(void)
+{
+  VT_VSlide_Init(40, 2, 10, &VTBench_a);
+  VT_VSlide_Draw(&VTBench_a);
+}
+
+static void VTBench_VSlide_Step(void)
+{
+  VT_VSlide_Handle(VT_KEY_UP, &VTBench_a);
+}
+
+static void VTBench_HBar_Setup(void)
+{
+  VT_HBar_Init(5, 14, 20, &VTBench_a);
+  VTBench_a.val2 = 5;
+  VT_HBar_Draw(&VTBench_a);
+}
+
+static void VTBench_HBar_Step(void)
+{
+  VTBench_a.val2 = 6;
+  VT_HBar_Draw(&VTBench_a);
+}
+
+static void VTBench_HBar_Fill(void)
+{
+  VTBench_a.val2 = 0;
+  VT_HBar_Draw(&VTBench_a);
+  VTBench_bytes = 0;
+  VTBench_a.val2 = 20;
+  VT_HBar_Draw(&VTBench_a);
+}
+
+static void VTBench_HBar_Sweep(void)
+{
+  uint8_t i;
+
+  for (i = 0; i <= 20; i++)
+  {
+    VTBench_a.val2 = i;
+    VT_HBar_Draw(&VTBench_a);
+  }
+  for (i = 20; i > 0; i--)
+  {
+    VTBench_a.val2 = i - 1;
+    VT_HBar_Draw(&VTBench_a);
+  }
+}
+
+static void VTBench_Scatter_Setup(void)
+{
+  VT_Scatter_Init(50, 2, 20, 10, &VTBench_a);
+}
+
+static void VTBench_Scatter_Point(void)
+{
+  VT_Scatter_Update(3, 4, &VTBench_a);
+}
+
+static void VTBench_Scatter_Plot(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < 20; i++)
+  {
+    VT_Scatter_Update(i, (i * 7) % 10, &VTBench_a);
+  }
+  VT_Scatter_Clear(&VTBench_a);
+}
+
+/**
+ * A chart holding 10 samples.
+ * @param x Left column.
+ * @param width Width in columns, VT_COLS for whole rows.
+ */
+static void VTBench_Chart_Setup(uint8_t x, uint8_t width)
+{
+  uint8_t i;
+
+  VT_Chart_Init(x, 16, width, 6, VTBench_ring, &VTBench_a);
+  for (i = 0; i < 10; i++)
+  {
+    VT_Chart_Add(&VTBench_a, i % 6);
+  }
+}
+
+static void VTBench_Chart_Rows_Setup(void)
+{
+  VTBench_Chart_Setup(1, VT_COLS);
+}
+
+static void VTBench_Chart_Box_Setup(void)
+{
+  VTBench_Chart_Setup(20, 30);
+}
+
+static void VTBench_Chart_Sample(void)
+{
+  VT_Chart_Add(&VTBench_a, 3);
+}
+
+static void VTBench_Chart_Stream(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < 50; i++)
+  {
+    VT_Chart_Add(&VTBench_a, (i * 5) % 30);
+  }
+}
+
+static void VTBench_Chart_Repaint(void)
+{
+  VTBench_a.prev = VT_ITEM_REDRAW;
+  VT_Chart_Draw(&VTBench_a);
+}
+
+static void VTBench_Number_Setup(void)
+{
+  VT_Number_Init(60, 20, 3, &VTBench_a);
+  VT_Number_Set(&VTBench_a, 123);
+}
+
+static void VTBench_Number_Last(void)
+{
+  VT_Number_Set(&VTBench_a, 124);
+}
+
+static void VTBench_Number_Three(void)
+{
+  VT_Number_Set(&VTBench_a, 200);
+}
+
+static void VTBench_Number_Count(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < 100; i++)
+  {
+    VT_Number_Set(&VTBench_a, i);
+  }
+}
+
+static void VTBench_Number_ADC_Setup(void)
+{
+  VT_Number_Init(60, 21, 4, &VTBench_a);
+  VT_Number_Set(&VTBench_a, 1000);
+}
+
+/**
+ * A 10-bit ADC10 reading drifting up by one count at a time.
+ */
+static void VTBench_Number_ADC(void)
+{
+  uint16_t i;
+
+  for (i = 1001; i <= 1023; i++)
+  {
+    VT_Number_Set(&VTBench_a, i);
+  }
+}
+
+static void VTBench_Box(void)
+{
+  VT_Box(10, 10, 20, 6);
+}
+
+static void VTBench_Box_Model_Setup(void)
+{
+  VT_Screen_Init(VTBench_cells, 80, 24);
+  VT_Refresh();
+}
+
+static void VTBench_Draw_Box_Model(void)
+{
+  VT_Goto(10, 10);
+  VT_Draw_Box(20, 6);
+  VT_Refresh();
+}
+
+/**
+ * A panel with a bar, a slider, and a readout, rendered at a fixed rate.
+ * @param model True to render through the screen model.
+ */
+static void VTBench_Panel_Setup(bool model)
+{
+  memset(VTBench_widgets, 0, sizeof(VTBench_widgets));
+  VT_HBar_Init(5, 4, 20, &VTBench_widgets[0].item);
+  VTBench_widgets[0].draw = VT_HBar_Draw;
+  VT_HSlide_Init(5, 6, 20, &VTBench_widgets[1].item);
+  VTBench_widgets[1].handle = VT_HSlide_Handle;
+  VTBench_widgets[1].draw = VT_HSlide_Draw;
+  VT_Number_Init(30, 4, 3, &VTBench_widgets[2].item);
+  VTBench_widgets[2].draw = VT_Number_Draw;
+  VT_Screen_Init(model ? VTBench_cells : 0, 80, 24);
+  VT_Panel_Init(&VTBench_panel, VTBench_widgets, 3, 1);
+  VT_Panel_Render(&VTBench_panel);
+  if (model)
+  {
+    VT_Refresh();
+  }
+}
+
+static void VTBench_Panel_Direct_Setup(void)
+{
+  VTBench_Panel_Setup(false);
+}
+
+static void VTBench_Panel_Model_Setup(void)
+{
+  VTBench_Panel_Setup(true);
+}
+
+/**
+ * 50 frames of a sensor value moving, with a key press every 10 frames.
+ */
+static void VTBench_Panel_Frames(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < 50; i++)
+  {
+    VT_Panel_Set(&VTBench_panel, 0, (i * 3) % 21);
+    VT_Panel_Set16(&VTBench_panel, 2, 100 + i);
+    if (i % 10 == 9)
+    {
+      VT_Panel_Key(&VTBench_panel, VT_KEY_RIGHT);
+    }
+    VT_Panel_Tick(&VTBench_panel);
+    VT_Panel_Render(&VTBench_panel);
+  }
+}
+
+static void VTBench_Screen_Setup(void)
+{
+  uint8_t i;
+
+  VT_Screen_Init(VTBench_cells, 80, 24);
+  for (i = 1; i <= 24; i++)
+  {
+    VT_Screen_Print(1, i, "The quick brown fox jumps over the lazy dog "
+        "0123456789 The quick brown fox jumps");
+  }
+}
+
+static void VTBench_Screen_Shown_Setup(void)
+{
+  VTBench_Screen_Setup();
+  VT_Refresh();
+}
+
+static void VTBench_Refresh(void)
+{
+  VT_Refresh();
+}
+
+static void VTBench_Refresh_One(void)
+{
+  VT_Screen_Put(40, 12, '#');
+  VT_Refresh();
+}
+
+static const VTBench_Session VTBench_sessions[] = {
+  { "hslide-step",    VTBench_HSlide_Setup,       VTBench_HSlide_Step },
+  { "hslide-drag",    VTBench_HSlide_Setup,       VTBench_HSlide_Drag },
+  { "vslide-step",    VTBench_VSlide_Setup,       VTBench_VSlide_Step },
+  { "hbar-step",      VTBench_HBar_Setup,         VTBench_HBar_Step },
+  { "hbar-fill",      VTBench_HBar_Setup,         VTBench_HBar_Fill },
+  { "hbar-sweep",     VTBench_HBar_Setup,         VTBench_HBar_Sweep },
+  { "scatter-point",  VTBench_Scatter_Setup,      VTBench_Scatter_Point },
+  { "scatter-plot",   VTBench_Scatter_Setup,      VTBench_Scatter_Plot },
+  { "chart-sample",   VTBench_Chart_Rows_Setup,   VTBench_Chart_Sample },
+  { "chart-stream",   VTBench_Chart_Rows_Setup,   VTBench_Chart_Stream },
+  { "chart-repaint",  VTBench_Chart_Rows_Setup,   VTBench_Chart_Repaint },
+  { "chart-box-sample", VTBench_Chart_Box_Setup,  VTBench_Chart_Sample },
+  { "chart-box-stream", VTBench_Chart_Box_Setup,  VTBench_Chart_Stream },
+  { "number-last",    VTBench_Number_Setup,       VTBench_Number_Last },
+  { "number-three",   VTBench_Number_Setup,       VTBench_Number_Three },
+  { "number-count",   VTBench_Number_Setup,       VTBench_Number_Count },
+  { "number-adc",     VTBench_Number_ADC_Setup,   VTBench_Number_ADC },
+  { "box-20x6",       0,                          VTBench_Box },
+  { "draw-box-model", VTBench_Box_Model_Setup,    VTBench_Draw_Box_Model },
+  { "panel-direct",   VTBench_Panel_Direct_Setup, VTBench_Panel_Frames },
+  { "panel-model",    VTBench_Panel_Model_Setup,  VTBench_Panel_Frames },
+  { "refresh-full",   VTBench_Screen_Setup,       VTBench_Refresh },
+  { "refresh-none",   VTBench_Screen_Shown_Setup, VTBench_Refresh },
+  { "refresh-one",    VTBench_Screen_Shown_Setup, VTBench_Refresh_One },
+};
+
+#define VTBENCH_SESSIONS \
+  (sizeof(VTBench_sessions) / sizeof(VTBench_sessions[0]))
+
+//=============================================================================
+// Baseline
+//=============================================================================
+
+/**
+ * Look up a session in the baseline file.
+ * Lines hold a session name and a byte count. Blank lines and lines
+ * starting with # are skipped.
+ * @param f The baseline file.
+ * @param name The session.
+ * @returns The baseline byte count, or -1 if the session isn't listed.
+ */
+static long VTBench_Baseline(FILE *f, const char *name)
+{
+  char line[128];
+  char key[VTBENCH_NAME_LEN + 1];
+  long bytes;
+
+  rewind(f);
+  while (fgets(line, sizeof(line), f))
+  {
+    if ((line[0] == '#')
+        || (sscanf(line, "%32s %ld", key, &bytes) != 2))
+    {
+      continue;
+    }
+    if (!strcmp(key, name))
+    {
+      return bytes;
+    }
+  }
+  return -1;
+}
+
+//=============================================================================
+// Main
+//=============================================================================
+
+int main(int argc, char *argv[])
+{
+  const char *path = "VTBench.baseline";
+  bool print = false;
+  unsigned failures = 0;
+  FILE *f = 0;
+  long base;
+  uint8_t i;
+
+  if ((argc > 1) && !strcmp(argv[1], "-p"))
+  {
+    print = true;
+  } else if (argc > 1) {
+    path = argv[1];
+  }
+  if (!print && !(f = fopen(path, "r")))
+  {
+    fprintf(stderr, "VTBench: can't read %s\n", path);
+    return 2;
+  }
+
+  if (!print)
+  {
+    printf("%-16s %7s %8s %11s %12s\n", "session", "bytes", "baseline",
+        "9600 baud", "115200 baud");
+  }
+  VT_SetTXFunc(VTBench_TX);
+  for (i = 0; i < VTBENCH_SESSIONS; i++)
+  {
+    // Every session starts from a known cursor position, without a model
+    VT_Screen_Init(0, 0, 0);
+    VT_Pos(1, 1);
+    if (VTBench_sessions[i].setup)
+    {
+      VTBench_sessions[i].setup();
+    }
+    VTBench_bytes = 0;
+    VTBench_sessions[i].run();
+
+    if (print)
+    {
+      printf("%-16s %6lu\n", VTBench_sessions[i].name,
+          (unsigned long)VTBench_bytes);
+      continue;
+    }
+    base = VTBench_Baseline(f, VTBench_sessions[i].name);
+    printf("%-16s %7lu %8ld %8.1f ms %9.2f ms", VTBench_sessions[i].name,
+        (unsigned long)VTBench_bytes, base,
+        VT_TX_US(VTBench_bytes, 9600) / 1000.0,
+        VT_TX_US(VTBench_bytes, 115200) / 1000.0);
+    if (base < 0)
+    {
+      printf("  FAIL, not in baseline\n");
+      failures++;
+    } else if ((long)VTBench_bytes > base) {
+      printf("  FAIL, %ld bytes over\n", (long)VTBench_bytes - base);
+      failures++;
+    } else if ((long)VTBench_bytes < base) {
+      printf("  (%ld under, lower the baseline)\n", base - (long)VTBench_bytes);
+    } else {
+      printf("\n");
+    }
+  }
+  if (f)
+  {
+    fclose(f);
+    printf("%u over baseline\n", failures);
+  }
+  return failures ? 1 : 0;
+}
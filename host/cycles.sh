@@ -0,0 +1,85 @@
+#!/bin/sh
+# Cycle counts of the BCDConv and Format routines, FIFO_Get/FIFO_Put,
+# DelayCycles, and the driver ISR bodies, on mspdebug's MSP430 simulator.
+# Cross-compiles CycleBench.c with the sources given as arguments, runs it
+# until CycleBench_Done, and prints the fewest and most cycles per call from
+# CycleBench_cycles. See CycleBench.c for what is counted.
+#
+# Usage: cycles.sh SOURCE...     (make cycles passes the sources)
+#
+# MSP430_CC, MSP430_MCU, MSP430_CFLAGS, and MSPDEBUG override the tools and
+# flags. If msp430-elf-gcc or mspdebug isn't installed, it says so and exits
+# without failing, so `make cycles` is safe to run anywhere.
+
+MSP430_CC=${MSP430_CC:-msp430-elf-gcc}
+MSP430_MCU=${MSP430_MCU:-msp430g2553}
+MSP430_CFLAGS=${MSP430_CFLAGS:--Os}
+MSPDEBUG=${MSPDEBUG:-mspdebug}
+ELF=CycleBench.elf
+
+for tool in "$MSP430_CC" "$MSPDEBUG"; do
+  if ! command -v "$tool" >/dev/null 2>&1; then
+    echo "skip: $tool not found, no cycle counts"
+    exit 0
+  fi
+done
+
+# Sibling calls are kept as calls, so each case pays for its call and ret
+# the way a caller in the firmware would.
+"$MSP430_CC" -mmcu="$MSP430_MCU" $MSP430_CFLAGS -std=gnu99 -fcommon \
+  -fno-optimize-sibling-calls -ffunction-sections -fdata-sections \
+  -Wl,--gc-sections -I.. -o "$ELF" "$@" || exit 1
+
+cases=$(grep -c '^  { "' CycleBench.c)
+
+# Timer0_A for TimerA0.c, and Timer1_A at its own address for the counts
+out=$(${TIMEOUT:-timeout 60} "$MSPDEBUG" -q sim \
+  "prog $ELF" \
+  "simio add timer ta0" \
+  "simio add timer ta1" \
+  "simio config ta1 base 0x0180" \
+  "simio config ta1 iv 0x011e" \
+  "reset" \
+  "setbreak CycleBench_Done" \
+  "run" \
+  "md CycleBench_cycles $((cases * 4))") || {
+  echo "$out"
+  echo "FAIL mspdebug did not reach CycleBench_Done"
+  exit 1
+}
+
+# md prints "address: bytes |ascii|". Pull out the bytes and pair them up
+# into little-endian words, the fewest then the most cycles of each case,
+# and name them from the CycleBench_cases lines in CycleBench.c.
+echo "$out" | awk -v cases="$cases" '
+  function hex(s,  i, v) {
+    v = 0
+    for (i = 1; i <= length(s); i++)
+      v = v * 16 + index("0123456789abcdef", tolower(substr(s, i, 1))) - 1
+    return v
+  }
+  FNR == NR {
+    if ($0 ~ /^  \{ "[^"]*",/) {
+      sub(/^  \{ "/, "")
+      sub(/".*/, "")
+      name[names++] = $0
+    }
+    next
+  }
+  /:/ && /\|/ {
+    sub(/^[^:]*:/, "")
+    sub(/\|.*/, "")
+    for (i = 1; i <= NF; i++)
+      if ($i ~ /^[0-9a-fA-F][0-9a-fA-F]$/) bytes[n++] = $i
+  }
+  END {
+    if (names != cases || n < cases * 4) {
+      print "FAIL could not read CycleBench_cycles"
+      exit 1
+    }
+    printf "%-20s %6s %6s\n", "case", "min", "max"
+    for (i = 0; i < cases; i++)
+      printf "%-20s %6d %6d\n", name[i],
+        hex(bytes[4 * i + 1] bytes[4 * i]),
+        hex(bytes[4 * i + 3] bytes[4 * i + 2])
+  }' CycleBench.c - || { echo "$out"; exit 1; }
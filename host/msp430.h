@@ -0,0 +1,406 @@
+/*
+ * @file msp430.h
+ * @brief Simulated MSP430G2xx register file for host builds
+ * @author Scott Teal (Scott@Teals.org)
+ * @date 2014-05-16
+ * @copyright
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Scott Teal
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+ *
+ * @details
+ * Stands in for the msp430-gcc device header in host builds (see Sim.h).
+ * The registers and bits used by this library are here, named and valued as
+ * in msp430g2553.h. Each register name expands to an lvalue that ticks the
+ * peripheral models before it is read or written, so driver code builds
+ * unchanged.
+ */
+
+#ifndef SIM_MSP430_H_
+#define SIM_MSP430_H_
+
+#include <stdint.h>
+#include "Sim.h"
+
+/// Defined in host builds, for code that has to tell
+#define SIM_HOST 1
+
+/// Access a simulated register, ticking the models first
+#define SIM_REG(r) (*(Sim_Tick(), &Sim_regs.r))
+
+// Registers
+// =========
+#define WDTCTL      SIM_REG(wdtctl)
+#define DCOCTL      SIM_REG(dcoctl)
+#define BCSCTL1     SIM_REG(bcsctl1)
+#define BCSCTL2     SIM_REG(bcsctl2)
+#define BCSCTL3     SIM_REG(bcsctl3)
+#define IE1         SIM_REG(ie1)
+#define IFG1        SIM_REG(ifg1)
+#define IE2         SIM_REG(ie2)
+#define IFG2        SIM_REG(ifg2)
+
+#define P1IN        SIM_REG(p1in)
+#define P1OUT       SIM_REG(p1out)
+#define P1DIR       SIM_REG(p1dir)
+#define P1SEL       SIM_REG(p1sel)
+#define P1SEL2      SIM_REG(p1sel2)
+#define P1REN       SIM_REG(p1ren)
+#define P1IE        SIM_REG(p1ie)
+#define P1IES       SIM_REG(p1ies)
+#define P1IFG       SIM_REG(p1ifg)
+
+#define P2IN        SIM_REG(p2in)
+#define P2OUT       SIM_REG(p2out)
+#define P2DIR       SIM_REG(p2dir)
+#define P2SEL       SIM_REG(p2sel)
+#define P2SEL2      SIM_REG(p2sel2)
+#define P2REN       SIM_REG(p2ren)
+#define P2IE        SIM_REG(p2ie)
+#define P2IES       SIM_REG(p2ies)
+#define P2IFG       SIM_REG(p2ifg)
+
+#define P3IN        SIM_REG(p3in)
+#define P3OUT       SIM_REG(p3out)
+#define P3DIR       SIM_REG(p3dir)
+#define P3SEL       SIM_REG(p3sel)
+#define P3SEL2      SIM_REG(p3sel2)
+#define P3REN       SIM_REG(p3ren)
+
+#define UCA0CTL0    SIM_REG(uca0ctl0)
+#define UCA0CTL1    SIM_REG(uca0ctl1)
+#define UCA0BR0     SIM_REG(uca0br0)
+#define UCA0BR1     SIM_REG(uca0br1)
+#define UCA0MCTL    SIM_REG(uca0mctl)
+#define UCA0STAT    SIM_REG(uca0stat)
+#define UCA0TXBUF   SIM_REG(uca0txbuf)
+#define UCA0ABCTL   SIM_REG(uca0abctl)
+
+#define UCB0CTL0    SIM_REG(ucb0ctl0)
+#define UCB0CTL1    SIM_REG(ucb0ctl1)
+#define UCB0BR0     SIM_REG(ucb0br0)
+#define UCB0BR1     SIM_REG(ucb0br1)
+#define UCB0I2CIE   SIM_REG(ucb0i2cie)
+#define UCB0STAT    SIM_REG(ucb0stat)
+#define UCB0TXBUF   SIM_REG(ucb0txbuf)
+#define UCB0I2COA   SIM_REG(ucb0i2coa)
+#define UCB0I2CSA   SIM_REG(ucb0i2csa)
+
+#define ADC10CTL0   SIM_REG(adc10ctl0)
+#define ADC10CTL1   SIM_REG(adc10ctl1)
+#define ADC10MEM    SIM_REG(adc10mem)
+#define ADC10AE0    SIM_REG(adc10ae0)
+#define ADC10DTC0   SIM_REG(adc10dtc0)
+#define ADC10DTC1   SIM_REG(adc10dtc1)
+#define ADC10SA     SIM_REG(adc10sa)
+
+#define TA0CTL      SIM_REG(ta0ctl)
+#define TA0R        SIM_REG(ta0r)
+#define TA0CCTL0    SIM_REG(ta0cctl0)
+#define TA0CCR0     SIM_REG(ta0ccr0)
+#define TA0CCTL1    SIM_REG(ta0cctl1)
+#define TA0CCR1     SIM_REG(ta0ccr1)
+#define TA0CCTL2    SIM_REG(ta0cctl2)
+#define TA0CCR2     SIM_REG(ta0ccr2)
+#define TA0IV       SIM_REG(ta0iv)
+
+#define TA1CTL      SIM_REG(ta1ctl)
+#define TA1R        SIM_REG(ta1r)
+#define TA1CCTL0    SIM_REG(ta1cctl0)
+#define TA1CCR0     SIM_REG(ta1ccr0)
+#define TA1CCTL1    SIM_REG(ta1cctl1)
+#define TA1CCR1     SIM_REG(ta1ccr1)
+#define TA1CCTL2    SIM_REG(ta1cctl2)
+#define TA1CCR2     SIM_REG(ta1ccr2)
+#define TA1IV       SIM_REG(ta1iv)
+
+// UCA0RXBUF and UCB0RXBUF clear their RXIFG when read
+#define UCA0RXBUF   (*Sim_UCA0RXBUF())
+#define UCB0RXBUF   (*Sim_UCB0RXBUF())
+
+// Aliases
+#define TACTL       TA0CTL
+#define TAR         TA0R
+#define TACCTL0     TA0CCTL0
+#define TACCR0      TA0CCR0
+#define CCTL0       TA0CCTL0
+#define CCR0        TA0CCR0
+
+// Intrinsics
+// ==========
+#define __get_SR_register()            Sim_GetSR()
+#define __bis_SR_register(x)           Sim_BisSR(x)
+#define __bic_SR_register(x)           Sim_BicSR(x)
+#define __bis_SR_register_on_exit(x)   Sim_BisSROnExit(x)
+#define __bic_SR_register_on_exit(x)   Sim_BicSROnExit(x)
+#define _bis_SR_register(x)            Sim_BisSR(x)
+#define _bic_SR_register(x)            Sim_BicSR(x)
+#define _bis_SR_register_on_exit(x)    Sim_BisSROnExit(x)
+#define _bic_SR_register_on_exit(x)    Sim_BicSROnExit(x)
+#define __disable_interrupt()          Sim_BicSR(GIE)
+#define __enable_interrupt()           Sim_BisSR(GIE)
+#define _disable_interrupts()          Sim_BicSR(GIE)
+#define _enable_interrupts()           Sim_BisSR(GIE)
+#define __delay_cycles(n)              Sim_Run(n)
+#define __no_operation()               Sim_Tick()
+
+// Interrupt vectors, as Sim_SetVector numbers
+#define TIMER1_A0_VECTOR  SIM_TIMER1_A0
+#define TIMER0_A0_VECTOR  SIM_TIMER0_A0
+#define USCIAB0RX_VECTOR  SIM_USCIAB0RX
+#define USCIAB0TX_VECTOR  SIM_USCIAB0TX
+#define ADC10_VECTOR      SIM_ADC10
+
+// Bits
+// ====
+#define BIT0  0x0001
+#define BIT1  0x0002
+#define BIT2  0x0004
+#define BIT3  0x0008
+#define BIT4  0x0010
+#define BIT5  0x0020
+#define BIT6  0x0040
+#define BIT7  0x0080
+#define BIT8  0x0100
+#define BIT9  0x0200
+#define BITA  0x0400
+#define BITB  0x0800
+#define BITC  0x1000
+#define BITD  0x2000
+#define BITE  0x4000
+#define BITF  0x8000
+
+// Status register
+#define GIE        0x0008
+#define CPUOFF     0x0010
+#define OSCOFF     0x0020
+#define SCG0       0x0040
+#define SCG1       0x0080
+#define LPM0_bits  (CPUOFF)
+#define LPM1_bits  (SCG0 | CPUOFF)
+#define LPM2_bits  (SCG1 | CPUOFF)
+#define LPM3_bits  (SCG1 | SCG0 | CPUOFF)
+#define LPM4_bits  (SCG1 | SCG0 | OSCOFF | CPUOFF)
+
+// Watchdog
+#define WDTPW      0x5A00
+#define WDTHOLD    0x0080
+
+// Basic clock
+#define XT2OFF     0x80
+#define DIVA_0     0x00
+#define DIVA_1     0x10
+#define DIVA_2     0x20
+#define DIVA_3     0x30
+#define SELM_0     0x00
+#define SELM_1     0x40
+#define SELM_2     0x80
+#define SELM_3     0xC0
+#define DIVM_0     0x00
+#define DIVM_1     0x10
+#define DIVM_2     0x20
+#define DIVM_3     0x30
+#define SELS       0x08
+#define DIVS_0     0x00
+#define DIVS_1     0x02
+#define DIVS_2     0x04
+#define DIVS_3     0x06
+#define LFXT1S_0   0x00
+#define LFXT1S_2   0x20
+#define LFXT1S_3   0x30
+#define XCAP_0     0x00
+#define XCAP_1     0x04
+#define XCAP_2     0x08
+#define XCAP_3     0x0C
+
+// IE2, IFG2
+#define UCA0RXIE   0x01
+#define UCA0TXIE   0x02
+#define UCB0RXIE   0x04
+#define UCB0TXIE   0x08
+#define UCA0RXIFG  0x01
+#define UCA0TXIFG  0x02
+#define UCB0RXIFG  0x04
+#define UCB0TXIFG  0x08
+
+// USCI control 0
+#define UCPEN      0x80
+#define UCPAR      0x40
+#define UCMSB      0x20
+#define UC7BIT     0x10
+#define UCSPB      0x08
+#define UCMODE_0   0x00
+#define UCMODE_1   0x02
+#define UCMODE_2   0x04
+#define UCMODE_3   0x06
+#define UCSYNC     0x01
+#define UCCKPH     0x80
+#define UCCKPL     0x40
+#define UCMST      0x08
+#define UCA10      0x80
+#define UCSLA10    0x40
+#define UCMM       0x20
+
+// USCI control 1
+#define UCSSEL_0   0x00
+#define UCSSEL_1   0x40
+#define UCSSEL_2   0x80
+#define UCSSEL_3   0xC0
+#define UCRXEIE    0x20
+#define UCBRKIE    0x10
+#define UCDORM     0x08
+#define UCTXADDR   0x04
+#define UCTXBRK    0x02
+#define UCTR       0x10
+#define UCTXNACK   0x08
+#define UCTXSTP    0x04
+#define UCTXSTT    0x02
+#define UCSWRST    0x01
+
+// USCI modulation
+#define UCBRF_0    0x00
+#define UCBRF0     0x10
+#define UCBRS_0    0x00
+#define UCBRS0     0x02
+#define UCOS16     0x01
+
+// USCI status
+#define UCLISTEN   0x80
+#define UCFE       0x40
+#define UCOE       0x20
+#define UCPE       0x10
+#define UCBRK      0x08
+#define UCRXERR    0x04
+#define UCADDR     0x02
+#define UCBUSY     0x01
+#define UCSCLLOW   0x40
+#define UCGC       0x20
+#define UCBBUSY    0x10
+#define UCNACKIFG  0x08
+#define UCSTPIFG   0x04
+#define UCSTTIFG   0x02
+#define UCALIFG    0x01
+
+// USCI I2C interrupt enable
+#define UCNACKIE   0x08
+#define UCSTPIE    0x04
+#define UCSTTIE    0x02
+#define UCALIE     0x01
+
+// ADC10 control 0
+#define SREF_0     0x0000
+#define SREF_1     0x2000
+#define ADC10SHT_0 0x0000
+#define ADC10SHT_1 0x0800
+#define ADC10SHT_2 0x1000
+#define ADC10SHT_3 0x1800
+#define ADC10SR    0x0400
+#define REFOUT     0x0200
+#define REFBURST   0x0100
+#define MSC        0x0080
+#define REF2_5V    0x0040
+#define REFON      0x0020
+#define ADC10ON    0x0010
+#define ADC10IE    0x0008
+#define ADC10IFG   0x0004
+#define ENC        0x0002
+#define ADC10SC    0x0001
+
+// ADC10 control 1
+#define INCH_10    0xA000
+#define SHS_0      0x0000
+#define ADC10DF    0x0200
+#define ISSH       0x0100
+#define ADC10DIV_0 0x0000
+#define ADC10DIV_1 0x0020
+#define ADC10DIV_2 0x0040
+#define ADC10DIV_3 0x0060
+#define ADC10DIV_4 0x0080
+#define ADC10DIV_5 0x00A0
+#define ADC10DIV_6 0x00C0
+#define ADC10DIV_7 0x00E0
+#define ADC10SSEL_0 0x0000
+#define ADC10SSEL_1 0x0008
+#define ADC10SSEL_2 0x0010
+#define ADC10SSEL_3 0x0018
+#define CONSEQ_0   0x0000
+#define CONSEQ_1   0x0002
+#define CONSEQ_2   0x0004
+#define CONSEQ_3   0x0006
+#define ADC10BUSY  0x0001
+
+// ADC10 data transfer control 0
+#define ADC10TB    0x08
+#define ADC10CT    0x04
+#define ADC10B1    0x02
+#define ADC10FETCH 0x01
+
+// Timer_A control
+#define TASSEL_0   0x0000
+#define TASSEL_1   0x0100
+#define TASSEL_2   0x0200
+#define TASSEL_3   0x0300
+#define ID_0       0x0000
+#define ID_1       0x0040
+#define ID_2       0x0080
+#define ID_3       0x00C0
+#define MC_0       0x0000
+#define MC_1       0x0010
+#define MC_2       0x0020
+#define MC_3       0x0030
+#define TACLR      0x0004
+#define TAIE       0x0002
+#define TAIFG      0x0001
+
+// Timer_A capture/compare control
+#define CAP        0x0100
+#define OUTMOD_0   0x0000
+#define CCIE       0x0010
+#define CCI        0x0008
+#define OUT        0x0004
+#define COV        0x0002
+#define CCIFG      0x0001
+
+// TLV segment, in the simulated Sim_tlv array
+#define TLV_CHECKSUM_     ((uintptr_t)Sim_tlv)
+#define TAG_DCO_30        0x01
+#define TAG_ADC10_1       0x10
+#define TAG_EMPTY         0xFE
+#define CAL_DCO_16MHZ     0
+#define CAL_BC1_16MHZ     1
+#define CAL_DCO_12MHZ     2
+#define CAL_BC1_12MHZ     3
+#define CAL_DCO_8MHZ      4
+#define CAL_BC1_8MHZ      5
+#define CAL_DCO_1MHZ      6
+#define CAL_BC1_1MHZ      7
+#define CAL_ADC_GAIN_FACTOR    0
+#define CAL_ADC_OFFSET         1
+#define CAL_ADC_15VREF_FACTOR  2
+#define CAL_ADC_15T30          3
+#define CAL_ADC_15T85          4
+#define CAL_ADC_25VREF_FACTOR  5
+#define CAL_ADC_25T30          6
+#define CAL_ADC_25T85          7
+
+#endif /* SIM_MSP430_H_ */
@@ -24,6 +24,9 @@
  * SOFTWARE.
  */
 
+/*
+ * Busy-wait for 3 cycles per count (dec, then jne). n must not be 0.
+ */
 static void __inline__ DelayCycles(register unsigned int n)
 {
     __asm__ __volatile__ (